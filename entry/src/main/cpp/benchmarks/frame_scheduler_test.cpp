@@ -0,0 +1,337 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+/*
+ * Host tests of the frame pacing of WPEViewOHOSFrameScheduler
+ * (platform/wpe_view_ohos_frame_scheduler.h). A synthetic vsync source
+ * ticks on a simulated clock at 60, 90, 120 and 144 Hz, with timestamps
+ * jittered by up to kJitterUs, and a producer that renders a new frame as
+ * soon as the last one is presented, as WebKit does while animating. The
+ * tests check the interval between presented frames against the refresh
+ * period (or the pinned rate) and print the measured jitter; the timer
+ * fallback is checked the same way against a timer that fires late.
+ *
+ * Exits non-zero if a check fails.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "platform/wpe_view_ohos_frame_scheduler.h"
+
+namespace {
+
+int s_failures = 0;
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++s_failures;                                                           \
+        }                                                                           \
+    } while (0)
+
+constexpr int64_t kJitterUs = 250;
+constexpr int kFrames = 600;
+
+class SyntheticVSync final : public WPEViewOHOSFrameScheduler::VSyncSource {
+public:
+    explicit SyntheticVSync(int hz)
+        : periodUs_(1000000 / hz)
+    {
+    }
+
+    bool Request() override
+    {
+        if (failing_)
+            return false;
+        requested_ = true;
+        return true;
+    }
+
+    int64_t PeriodUs() const override { return periodUs_; }
+
+    // Delivers vsync `index` if one was requested.
+    void Tick(WPEViewOHOSFrameScheduler& scheduler, int64_t index)
+    {
+        const int64_t timestampUs = index * periodUs_ + jitter_(random_);
+        if (!requested_)
+            return;
+        requested_ = false;
+        ++delivered_;
+        scheduler.OnVSync(timestampUs);
+    }
+
+    int64_t periodUs_;
+    bool failing_ = false;
+    bool requested_ = false;
+    int delivered_ = 0;
+
+private:
+    std::mt19937 random_ { 42 };
+    std::uniform_int_distribution<int64_t> jitter_ { -kJitterUs, kJitterUs };
+};
+
+// Presented frame times, and a producer that requests the next frame from
+// the frame callback.
+struct Producer {
+    std::vector<int64_t> frameTimes;
+    bool continuous = true;
+    bool inRequestFrame = false;
+    WPEViewOHOSFrameScheduler* scheduler = nullptr;
+
+    void RequestFrame()
+    {
+        inRequestFrame = true;
+        scheduler->RequestFrame();
+        inRequestFrame = false;
+    }
+};
+
+std::unique_ptr<WPEViewOHOSFrameScheduler> createScheduler(Producer& producer)
+{
+    auto scheduler = std::make_unique<WPEViewOHOSFrameScheduler>([&producer](int64_t frameTimeUs) {
+        // Never presents from within RequestFrame().
+        CHECK(!producer.inRequestFrame);
+        producer.frameTimes.push_back(frameTimeUs);
+        if (producer.continuous)
+            producer.RequestFrame();
+    });
+    producer.scheduler = scheduler.get();
+    return scheduler;
+}
+
+// Checks every interval between frames against expectedUs, give or take
+// toleranceUs, and prints the mean and deviation.
+void checkPacing(const char* name, const std::vector<int64_t>& frameTimes, int64_t expectedUs, int64_t toleranceUs)
+{
+    CHECK(frameTimes.size() > 1);
+    if (frameTimes.size() < 2)
+        return;
+
+    int64_t maxDeviationUs = 0;
+    double sumUs = 0;
+    double sumSquares = 0;
+    for (size_t i = 1; i < frameTimes.size(); ++i) {
+        const int64_t intervalUs = frameTimes[i] - frameTimes[i - 1];
+        const int64_t deviationUs = intervalUs - expectedUs;
+        maxDeviationUs = std::max(maxDeviationUs, std::abs(deviationUs));
+        sumUs += intervalUs;
+        sumSquares += static_cast<double>(deviationUs) * deviationUs;
+    }
+    const size_t intervals = frameTimes.size() - 1;
+    std::fprintf(stderr, "%-28s %4zu frames, interval %.3f ms (expected %.3f), jitter %.3f ms rms, %.3f ms max\n",
+        name, frameTimes.size(), sumUs / intervals / 1000.0, expectedUs / 1000.0,
+        std::sqrt(sumSquares / intervals) / 1000.0, maxDeviationUs / 1000.0);
+    CHECK(maxDeviationUs <= toleranceUs);
+}
+
+// Every vsync presents a frame: two vsyncs' jitter apart at most.
+void testDisplayRate()
+{
+    for (int hz : { 60, 90, 120, 144 }) {
+        Producer producer;
+        auto scheduler = createScheduler(producer);
+        auto source = std::make_unique<SyntheticVSync>(hz);
+        auto* vsync = source.get();
+        scheduler->SetVSyncSource(std::move(source));
+        CHECK(scheduler->UsesVSync());
+        CHECK(scheduler->FrameIntervalUs() == vsync->periodUs_);
+
+        producer.RequestFrame();
+        for (int64_t i = 1; i <= kFrames; ++i)
+            vsync->Tick(*scheduler, i);
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "vsync %d Hz", hz);
+        CHECK(producer.frameTimes.size() == static_cast<size_t>(kFrames));
+        checkPacing(name, producer.frameTimes, vsync->periodUs_, 2 * kJitterUs);
+    }
+}
+
+// A pinned rate presents on every Nth vsync, N the smallest whole number
+// that brings the refresh rate down to it.
+void testPinnedRate()
+{
+    struct {
+        int hz;
+        int fps;
+        int refreshesPerFrame;
+    } cases[] = {
+        { 120, 120, 1 },
+        { 120, 60, 2 },
+        { 120, 30, 4 },
+        { 60, 120, 1 },
+        { 60, 30, 2 },
+        { 90, 60, 2 },
+        { 90, 30, 3 },
+        { 144, 60, 3 },
+    };
+
+    for (const auto& testCase : cases) {
+        Producer producer;
+        auto scheduler = createScheduler(producer);
+        auto source = std::make_unique<SyntheticVSync>(testCase.hz);
+        auto* vsync = source.get();
+        scheduler->SetVSyncSource(std::move(source));
+        scheduler->SetFrameRate(testCase.fps);
+        CHECK(scheduler->FrameIntervalUs() == testCase.refreshesPerFrame * vsync->periodUs_);
+
+        producer.RequestFrame();
+        for (int64_t i = 1; i <= kFrames; ++i)
+            vsync->Tick(*scheduler, i);
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "vsync %d Hz pinned %d fps", testCase.hz, testCase.fps);
+        CHECK(producer.frameTimes.size() == static_cast<size_t>(kFrames / testCase.refreshesPerFrame));
+        checkPacing(name, producer.frameTimes, testCase.refreshesPerFrame * vsync->periodUs_, 2 * kJitterUs);
+    }
+}
+
+// A frame requested after a pause goes out on the next vsync, and nothing
+// is presented for a cancelled request.
+void testIdleAndCancel()
+{
+    Producer producer;
+    producer.continuous = false;
+    auto scheduler = createScheduler(producer);
+    auto source = std::make_unique<SyntheticVSync>(120);
+    auto* vsync = source.get();
+    scheduler->SetVSyncSource(std::move(source));
+    scheduler->SetFrameRate(30);
+
+    producer.RequestFrame();
+    vsync->Tick(*scheduler, 1);
+    CHECK(producer.frameTimes.size() == 1);
+
+    // Idle for a while; no vsync is requested meanwhile.
+    for (int64_t i = 2; i <= 20; ++i)
+        vsync->Tick(*scheduler, i);
+    CHECK(vsync->delivered_ == 1);
+
+    producer.RequestFrame();
+    vsync->Tick(*scheduler, 21);
+    CHECK(producer.frameTimes.size() == 2);
+
+    // Within the pinned interval the frame waits for its vsync.
+    producer.RequestFrame();
+    vsync->Tick(*scheduler, 22);
+    vsync->Tick(*scheduler, 23);
+    vsync->Tick(*scheduler, 24);
+    CHECK(producer.frameTimes.size() == 2);
+    vsync->Tick(*scheduler, 25);
+    CHECK(producer.frameTimes.size() == 3);
+
+    producer.RequestFrame();
+    scheduler->Cancel();
+    for (int64_t i = 26; i <= 40; ++i)
+        vsync->Tick(*scheduler, i);
+    CHECK(producer.frameTimes.size() == 3);
+}
+
+// Runs the timer path: the timer fires up to maxLatencyUs after its
+// deadline, as a loaded main loop does.
+void runTimer(WPEViewOHOSFrameScheduler& scheduler, Producer& producer, int64_t startUs, int64_t maxLatencyUs)
+{
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int64_t> latency(0, maxLatencyUs);
+
+    int64_t nowUs = startUs;
+    producer.RequestFrame();
+    while (producer.frameTimes.size() < static_cast<size_t>(kFrames)) {
+        const int64_t deadlineUs = scheduler.TimerDeadline(nowUs);
+        CHECK(deadlineUs >= nowUs);
+        if (deadlineUs < nowUs)
+            return;
+        nowUs = deadlineUs + latency(random);
+        scheduler.OnTimer(nowUs);
+    }
+}
+
+// Without vsync the timer runs at the refresh rate and stays on its grid,
+// so the lateness does not add up.
+void testTimerFallback()
+{
+    constexpr int64_t kLatencyUs = 500;
+
+    {
+        Producer producer;
+        auto scheduler = createScheduler(producer);
+        scheduler->SetRefreshRate(120);
+        CHECK(!scheduler->UsesVSync());
+        runTimer(*scheduler, producer, 1000, kLatencyUs);
+        CHECK(producer.frameTimes.size() == static_cast<size_t>(kFrames));
+        checkPacing("timer 120 Hz", producer.frameTimes, 1000000 / 120, kLatencyUs);
+        const int64_t driftUs = producer.frameTimes.back() - producer.frameTimes.front() - (kFrames - 1) * (1000000 / 120);
+        CHECK(driftUs >= 0 && driftUs <= kLatencyUs);
+    }
+
+    {
+        Producer producer;
+        auto scheduler = createScheduler(producer);
+        scheduler->SetRefreshRate(120);
+        scheduler->SetFrameRate(60);
+        runTimer(*scheduler, producer, 1000, kLatencyUs);
+        checkPacing("timer 120 Hz pinned 60 fps", producer.frameTimes, 2 * (1000000 / 120), kLatencyUs);
+    }
+
+    // A source that stops working hands over to the timer at its rate.
+    {
+        Producer producer;
+        auto scheduler = createScheduler(producer);
+        auto source = std::make_unique<SyntheticVSync>(90);
+        auto* vsync = source.get();
+        scheduler->SetVSyncSource(std::move(source));
+        producer.RequestFrame();
+        for (int64_t i = 1; i < 10; ++i)
+            vsync->Tick(*scheduler, i);
+        vsync->failing_ = true;
+        vsync->Tick(*scheduler, 10);
+        CHECK(producer.frameTimes.size() == 10);
+        CHECK(!scheduler->UsesVSync());
+        CHECK(scheduler->RefreshPeriodUs() == 1000000 / 90);
+
+        producer.frameTimes.clear();
+        runTimer(*scheduler, producer, 10 * (1000000 / 90), kLatencyUs);
+        checkPacing("timer after vsync 90 Hz", producer.frameTimes, 1000000 / 90, kLatencyUs);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testDisplayRate();
+    testPinnedRate();
+    testIdleAndCancel();
+    testTimerFallback();
+
+    if (s_failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", s_failures);
+        return 1;
+    }
+    std::fprintf(stderr, "all checks passed\n");
+    return 0;
+}
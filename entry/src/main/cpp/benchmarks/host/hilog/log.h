@@ -0,0 +1,68 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+/*
+ * Host stand-in for the OHOS hilog NDK header, so that runtime sources using
+ * common/log.h build on plain Linux. Messages go to stderr (stdout carries the
+ * benchmark JSON) with hilog's {public}/{private} format qualifiers stripped.
+ */
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+enum LogType {
+    LOG_APP = 0,
+};
+
+enum LogLevel {
+    LOG_DEBUG = 3,
+    LOG_INFO = 4,
+    LOG_WARN = 5,
+    LOG_ERROR = 6,
+    LOG_FATAL = 7,
+};
+
+__attribute__((unused)) static int OH_LOG_Print(LogType, LogLevel level, unsigned int, const char* tag, const char* fmt, ...)
+{
+    if (level < LOG_INFO)
+        return 0;
+
+    char format[512];
+    size_t length = 0;
+    for (const char* c = fmt; *c != '\0' && length + 1 < sizeof(format); ++c) {
+        format[length++] = *c;
+        if (*c != '%')
+            continue;
+        if (std::strncmp(c + 1, "{public}", 8) == 0)
+            c += 8;
+        else if (std::strncmp(c + 1, "{private}", 9) == 0)
+            c += 9;
+    }
+    format[length] = '\0';
+
+    std::fprintf(stderr, "[%s] ", tag);
+    va_list args;
+    va_start(args, fmt);
+    const int written = std::vfprintf(stderr, format, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+    return written;
+}
@@ -0,0 +1,229 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Host tests of the MemoryPressure parsers (runtime/memory_pressure.h) on
+ * captured files in fixtures/memory_pressure:
+ *
+ *   meminfo_linux.txt  a desktop kernel's /proc/meminfo
+ *   meminfo_ohos.txt   an OHOS device's: no MemAvailable, vendor fields
+ *                      without a number, a number with trailing text and an
+ *                      empty value, the lines WebKit's parser spins on
+ *   meminfo_low.txt    a device close to running out of memory
+ *
+ * Takes the fixture directory as its only argument; exits non-zero if a
+ * check fails.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "runtime/memory_pressure.h"
+
+namespace {
+
+int s_failures = 0;
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++s_failures;                                                           \
+        }                                                                           \
+    } while (0)
+
+std::string s_fixtureDir;
+
+std::string readFixture(const char* name)
+{
+    std::ifstream file(s_fixtureDir + "/" + name);
+    if (!file) {
+        std::fprintf(stderr, "missing fixture %s\n", name);
+        ++s_failures;
+        return std::string();
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+void testMeminfoLinux()
+{
+    MemoryPressure::MeminfoSample sample;
+    CHECK(MemoryPressure::ParseMeminfo(readFixture("meminfo_linux.txt"), sample));
+    CHECK(sample.hasMemAvailable);
+    CHECK(sample.totalKb > 0);
+    CHECK(sample.availableKb > 0 && sample.availableKb <= sample.totalKb);
+}
+
+void testMeminfoOhos()
+{
+    MemoryPressure::MeminfoSample sample;
+    CHECK(MemoryPressure::ParseMeminfo(readFixture("meminfo_ohos.txt"), sample));
+    CHECK(!sample.hasMemAvailable);
+    CHECK(sample.totalKb == 3894228);
+    // MemFree + Active(file) + Inactive(file) + SReclaimable.
+    CHECK(sample.availableKb == 214560 + 435236 + 552372 + 88500);
+}
+
+void testMeminfoMalformed()
+{
+    MemoryPressure::MeminfoSample sample;
+    CHECK(!MemoryPressure::ParseMeminfo("", sample));
+    CHECK(!MemoryPressure::ParseMeminfo("MemFree: 10 kB\n", sample));
+    CHECK(!MemoryPressure::ParseMeminfo("MemTotal: lots\nMemAvailable: 10 kB\n", sample));
+    CHECK(!MemoryPressure::ParseMeminfo("MemTotal: 100 MB\nMemAvailable: 10 kB\n", sample));
+
+    // No trailing newline, CRLF, a bare number and a key without a colon.
+    CHECK(MemoryPressure::ParseMeminfo("garbage line\r\nMemTotal:\t1000\r\nMemAvailable: 2000 kB", sample));
+    CHECK(sample.totalKb == 1000);
+    CHECK(sample.availableKb == 1000);
+
+    // Only MemFree to go on.
+    CHECK(MemoryPressure::ParseMeminfo("MemTotal: 1000 kB\nMemFree: 100 kB\nCached: 50 kB\nBuffers: 5 kB\n", sample));
+    CHECK(sample.availableKb == 155);
+}
+
+void testCgroup()
+{
+    std::string path;
+    bool isV2 = true;
+    CHECK(MemoryPressure::ParseCgroupPath(readFixture("cgroup_v1.txt"), path, isV2));
+    CHECK(!isV2);
+    CHECK(path == "/apps/com.kodegood.webkitview");
+
+    CHECK(MemoryPressure::ParseCgroupPath(readFixture("cgroup_v2.txt"), path, isV2));
+    CHECK(isV2);
+    CHECK(path == "/user.slice/user-1000.slice/app.slice/webkitview.scope");
+
+    CHECK(!MemoryPressure::ParseCgroupPath("3:cpuset:/\n", path, isV2));
+
+    uint64_t bytes = 0;
+    CHECK(MemoryPressure::ParseCgroupBytes("max\n", bytes));
+    CHECK(bytes == std::numeric_limits<uint64_t>::max());
+    CHECK(MemoryPressure::ParseCgroupBytes("536870912\n", bytes));
+    CHECK(bytes == 536870912);
+    CHECK(!MemoryPressure::ParseCgroupBytes("", bytes));
+}
+
+void testPsi()
+{
+    MemoryPressure::PsiSample psi;
+    CHECK(MemoryPressure::ParsePsi(readFixture("psi_memory.txt"), psi));
+    CHECK(psi.someAvg10 == 12.5);
+    CHECK(psi.fullAvg10 == 6.25);
+    CHECK(!MemoryPressure::ParsePsi("", psi));
+}
+
+void testEvaluate()
+{
+    const MemoryPressure::Thresholds thresholds;
+
+    MemoryPressure::MeminfoSample meminfo;
+    CHECK(MemoryPressure::ParseMeminfo(readFixture("meminfo_low.txt"), meminfo));
+    MemoryPressure::Reading reading = MemoryPressure::Combine(meminfo, std::numeric_limits<uint64_t>::max(), 0);
+    CHECK(MemoryPressure::Evaluate(reading, thresholds) == MemoryPressure::Level::Critical);
+
+    // 80% used: fine by meminfo alone, but a cgroup at 92% of its limit is not.
+    meminfo.totalKb = 1000000;
+    meminfo.availableKb = 200000;
+    reading = MemoryPressure::Combine(meminfo, std::numeric_limits<uint64_t>::max(), 0);
+    CHECK(MemoryPressure::Evaluate(reading, thresholds) == MemoryPressure::Level::None);
+    reading = MemoryPressure::Combine(meminfo, 500000ull * 1024, 460000ull * 1024);
+    CHECK(reading.totalKb == 500000);
+    CHECK(reading.availableKb == 40000);
+    CHECK(MemoryPressure::Evaluate(reading, thresholds) == MemoryPressure::Level::NonCritical);
+
+    // A limit above the machine's memory is no limit.
+    reading = MemoryPressure::Combine(meminfo, 9223372036854771712ull, 460000ull * 1024);
+    CHECK(reading.totalKb == 1000000);
+
+    // PSI raises the level on its own.
+    reading = MemoryPressure::Combine(meminfo, std::numeric_limits<uint64_t>::max(), 0);
+    reading.hasPsi = true;
+    CHECK(MemoryPressure::ParsePsi(readFixture("psi_memory.txt"), reading.psi));
+    CHECK(MemoryPressure::Evaluate(reading, thresholds) == MemoryPressure::Level::Critical);
+    reading.psi.fullAvg10 = 0;
+    CHECK(MemoryPressure::Evaluate(reading, thresholds) == MemoryPressure::Level::NonCritical);
+}
+
+void testEvaluateHysteresis()
+{
+    using MemoryPressure::Level;
+    const MemoryPressure::Thresholds thresholds;
+
+    MemoryPressure::MeminfoSample meminfo;
+    meminfo.totalKb = 1000000;
+    const auto evaluate = [&](uint64_t usedPct, Level current) {
+        meminfo.availableKb = meminfo.totalKb - meminfo.totalKb * usedPct / 100;
+        return MemoryPressure::Evaluate(MemoryPressure::Combine(meminfo, std::numeric_limits<uint64_t>::max(), 0),
+            thresholds, current);
+    };
+
+    // Entering a level takes the full threshold, leaving it the margin below.
+    CHECK(evaluate(89, Level::None) == Level::None);
+    CHECK(evaluate(90, Level::None) == Level::NonCritical);
+    CHECK(evaluate(89, Level::NonCritical) == Level::NonCritical);
+    CHECK(evaluate(85, Level::NonCritical) == Level::NonCritical);
+    CHECK(evaluate(84, Level::NonCritical) == Level::None);
+    CHECK(evaluate(94, Level::NonCritical) == Level::NonCritical);
+    CHECK(evaluate(95, Level::NonCritical) == Level::Critical);
+    CHECK(evaluate(90, Level::Critical) == Level::Critical);
+    CHECK(evaluate(89, Level::Critical) == Level::NonCritical);
+    CHECK(evaluate(84, Level::Critical) == Level::None);
+
+    // PSI is released at half its threshold.
+    MemoryPressure::Reading reading = MemoryPressure::Combine(meminfo, std::numeric_limits<uint64_t>::max(), 0);
+    reading.availableKb = reading.totalKb;
+    reading.hasPsi = true;
+    reading.psi.someAvg10 = 6;
+    CHECK(MemoryPressure::Evaluate(reading, thresholds, Level::None) == Level::None);
+    CHECK(MemoryPressure::Evaluate(reading, thresholds, Level::NonCritical) == Level::NonCritical);
+    reading.psi.someAvg10 = 4;
+    CHECK(MemoryPressure::Evaluate(reading, thresholds, Level::NonCritical) == Level::None);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <fixture dir>\n", argv[0]);
+        return 2;
+    }
+    s_fixtureDir = argv[1];
+
+    testMeminfoLinux();
+    testMeminfoOhos();
+    testMeminfoMalformed();
+    testCgroup();
+    testPsi();
+    testEvaluate();
+    testEvaluateHysteresis();
+
+    if (s_failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", s_failures);
+        return 1;
+    }
+    std::fprintf(stderr, "all checks passed\n");
+    return 0;
+}
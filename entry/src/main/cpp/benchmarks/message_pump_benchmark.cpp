@@ -0,0 +1,1291 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Host-side MessagePump benchmark and stress suite.
+ *
+ * Builds runtime/message_pump.cpp against the system libuv and GLib and drives
+ * it the way the ArkTS main loop does: the calling thread owns a uv loop, the
+ * pump runs GLib from its prepare/check phases. Results are printed as one
+ * JSON document (stdout or --output), log output goes to stderr.
+ *
+ *   --quick            smaller iteration counts (used by ctest)
+ *   --filter=<text>    only run benchmarks whose name contains <text>
+ *   --output=<path>    write the JSON to <path> instead of stdout
+ *
+ * The process exits non-zero when a benchmark did not complete or a check
+ * failed (e.g. an inline-sized invoke allocating).
+ */
+
+#include <glib.h>
+#include <glib-unix.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <uv.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "runtime/message_pump.h"
+#include "runtime/webkit_thread.h"
+
+namespace {
+
+std::atomic<bool> s_countAllocations { false };
+std::atomic<uint64_t> s_allocations { 0 };
+
+} // namespace
+
+// Counts operator new while a benchmark asks for it. GLib allocates with
+// malloc and is deliberately not counted: this tracks the C++ post path.
+// The array forms are replaced too, so every new/delete pair in the binary
+// goes through the same malloc/free. The deletes are kept out of line:
+// inlined, GCC sees free() on a pointer from operator new and warns
+// (-Wmismatched-new-delete) although the two match here.
+void* operator new(std::size_t size)
+{
+    if (s_countAllocations.load(std::memory_order_relaxed))
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size != 0 ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace {
+
+constexpr uint64_t kRunTimeoutMs = 60000;
+
+struct Config {
+    bool quick = false;
+    std::string filter;
+    std::string output;
+};
+
+std::vector<std::string> s_failures;
+
+void fail(const std::string& what)
+{
+    std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+    s_failures.push_back(what);
+}
+
+uint64_t now()
+{
+    return MessagePumpStats::now();
+}
+
+uint64_t threadCpuTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+const char* pollModeName(MessagePump::PollMode mode)
+{
+    return mode == MessagePump::PollMode::Epoll ? "epoll" : "per_fd";
+}
+
+class JsonObject final {
+public:
+    JsonObject& string(const char* key, const std::string& value)
+    {
+        appendKey(key);
+        m_body += '"';
+        m_body += value;
+        m_body += '"';
+        return *this;
+    }
+
+    JsonObject& count(const char* key, uint64_t value)
+    {
+        appendKey(key);
+        m_body += std::to_string(value);
+        return *this;
+    }
+
+    JsonObject& number(const char* key, double value)
+    {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+        appendKey(key);
+        m_body += buffer;
+        return *this;
+    }
+
+    JsonObject& boolean(const char* key, bool value)
+    {
+        appendKey(key);
+        m_body += value ? "true" : "false";
+        return *this;
+    }
+
+    JsonObject& raw(const char* key, const std::string& json)
+    {
+        appendKey(key);
+        m_body += json;
+        return *this;
+    }
+
+    std::string str() const
+    {
+        return "{" + m_body + "}";
+    }
+
+private:
+    void appendKey(const char* key)
+    {
+        if (!m_body.empty())
+            m_body += ',';
+        m_body += '"';
+        m_body += key;
+        m_body += "\":";
+    }
+
+    std::string m_body;
+};
+
+// Distribution of nanosecond samples, reported in microseconds.
+std::string summarizeUs(std::vector<int64_t> samples)
+{
+    JsonObject summary;
+    summary.count("count", samples.size());
+    if (samples.empty())
+        return summary.str();
+
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double percent) {
+        const auto index = static_cast<size_t>(percent / 100.0 * static_cast<double>(samples.size()));
+        return static_cast<double>(samples[std::min(index, samples.size() - 1)]) / 1000.0;
+    };
+    double total = 0;
+    for (int64_t sample : samples)
+        total += static_cast<double>(sample);
+
+    return summary.number("minUs", static_cast<double>(samples.front()) / 1000.0)
+        .number("meanUs", total / static_cast<double>(samples.size()) / 1000.0)
+        .number("p50Us", at(50))
+        .number("p99Us", at(99))
+        .number("p999Us", at(99.9))
+        .number("maxUs", static_cast<double>(samples.back()) / 1000.0)
+        .str();
+}
+
+/*
+ * One uv loop with a MessagePump on the calling thread, which owns GLib's
+ * default context for the harness' lifetime. Only one harness may exist at a
+ * time, and GLib sources a benchmark attaches must be gone before it dies.
+ */
+class PumpHarness final {
+public:
+    explicit PumpHarness(const MessagePump::Options& options = {})
+    {
+        uv_loop_init(&m_loop);
+        uv_timer_init(&m_loop, &m_deadline);
+        m_deadline.data = this;
+        m_pump = std::make_unique<MessagePump>(&m_loop, options);
+    }
+
+    PumpHarness(const PumpHarness&) = delete;
+    PumpHarness& operator=(const PumpHarness&) = delete;
+
+    ~PumpHarness()
+    {
+        m_pump.reset();
+        uv_close(reinterpret_cast<uv_handle_t*>(&m_deadline), nullptr);
+        uv_run(&m_loop, UV_RUN_DEFAULT);
+        uv_loop_close(&m_loop);
+    }
+
+    MessagePump& pump() { return *m_pump; }
+    uv_loop_t* loop() { return &m_loop; }
+
+    // Runs the loop until stop() or `timeoutMs`; false on timeout. The pump's
+    // handles are unreferenced (on device other handles keep the ArkTS loop
+    // alive), so the deadline timer is what keeps uv_run going here.
+    bool run(uint64_t timeoutMs)
+    {
+        m_timedOut = false;
+        uv_timer_start(&m_deadline, [](uv_timer_t* timer) {
+            auto* harness = static_cast<PumpHarness*>(timer->data);
+            harness->m_timedOut = true;
+            uv_stop(&harness->m_loop);
+        }, timeoutMs, 0);
+        uv_run(&m_loop, UV_RUN_DEFAULT);
+        uv_timer_stop(&m_deadline);
+        return !m_timedOut;
+    }
+
+    void stop() { uv_stop(&m_loop); }
+
+    void closeHandle(uv_handle_t* handle)
+    {
+        uv_close(handle, nullptr);
+        uv_run(&m_loop, UV_RUN_NOWAIT);
+    }
+
+private:
+    uv_loop_t m_loop;
+    uv_timer_t m_deadline;
+    bool m_timedOut = false;
+    std::unique_ptr<MessagePump> m_pump;
+};
+
+enum class PostPath {
+    InvokeQueue,
+    // The pre-InvokeTask path: one idle GSource per post plus an explicit
+    // context wakeup. (It also kicked the pump's uv_async, which is private;
+    // the GLib wakeup fd the pump polls has the same effect once armed.)
+    LegacyIdleSource,
+};
+
+const char* postPathName(PostPath path)
+{
+    return path == PostPath::InvokeQueue ? "invoke_queue" : "legacy_idle_source";
+}
+
+void postLegacy(GSourceFunc callback, gpointer data)
+{
+    GMainContext* context = g_main_context_default();
+    GSource* source = g_idle_source_new();
+    g_source_set_priority(source, G_PRIORITY_DEFAULT);
+    g_source_set_callback(source, callback, data, nullptr);
+    g_source_attach(source, context);
+    g_source_unref(source);
+    g_main_context_wakeup(context);
+}
+
+// Runs whatever legacy idle sources a timed-out benchmark left behind, so
+// none outlives the state it points to.
+void flushLegacyPosts()
+{
+    while (g_main_context_iteration(g_main_context_default(), FALSE)) { }
+}
+
+// ---- Cross-thread invoke throughput ----
+
+struct ThroughputState {
+    PumpHarness* harness;
+    uint64_t total;
+    uint64_t executed = 0;
+};
+
+void onThroughputTask(ThroughputState* state)
+{
+    if (++state->executed == state->total)
+        state->harness->stop();
+}
+
+gboolean onLegacyThroughputIdle(gpointer data)
+{
+    onThroughputTask(static_cast<ThroughputState*>(data));
+    return G_SOURCE_REMOVE;
+}
+
+std::string benchInvokeThroughput(const Config& config, PostPath path, unsigned producers)
+{
+    const uint64_t perProducer = config.quick ? 20000 : 200000;
+    PumpHarness harness;
+    ThroughputState state { &harness, perProducer * producers };
+
+    std::atomic<bool> start { false };
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < producers; ++i) {
+        threads.emplace_back([&harness, &state, &start, path, perProducer] {
+            while (!start.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            for (uint64_t n = 0; n < perProducer; ++n) {
+                if (path == PostPath::InvokeQueue)
+                    harness.pump().invoke([target = &state] { onThroughputTask(target); });
+                else
+                    postLegacy(onLegacyThroughputIdle, &state);
+            }
+        });
+    }
+
+    const uint64_t begin = now();
+    start.store(true, std::memory_order_release);
+    bool completed = harness.run(kRunTimeoutMs);
+    const uint64_t elapsed = now() - begin;
+    for (auto& thread : threads)
+        thread.join();
+    if (!completed) {
+        fail(std::string("invoke_cross_thread_throughput/") + postPathName(path) + " timed out");
+        flushLegacyPosts();
+    }
+
+    return JsonObject()
+        .string("name", "invoke_cross_thread_throughput")
+        .string("path", postPathName(path))
+        .count("producers", producers)
+        .count("posts", state.total)
+        .count("executed", state.executed)
+        .boolean("completed", completed)
+        .number("elapsedMs", static_cast<double>(elapsed) / 1e6)
+        .number("postsPerSecond", static_cast<double>(state.executed) / (static_cast<double>(elapsed) / 1e9))
+        .str();
+}
+
+// ---- Same-thread invoke latency ----
+
+enum class PostOrigin {
+    // Posted from inside the previous task, i.e. during GLib dispatch.
+    Task,
+    // Posted from a libuv callback, outside any GLib iteration: measures the
+    // full wakeup -> prepare -> poll -> check -> dispatch round trip.
+    Libuv,
+};
+
+struct LatencyState {
+    PumpHarness* harness;
+    PostPath path;
+    PostOrigin origin;
+    size_t target;
+    std::vector<int64_t> samples {};
+    uint64_t postedAt = 0;
+    uv_timer_t repost {};
+};
+
+void postLatencyProbe(LatencyState* state);
+
+void onLatencyProbe(LatencyState* state)
+{
+    state->samples.push_back(static_cast<int64_t>(now() - state->postedAt));
+    if (state->samples.size() == state->target) {
+        state->harness->stop();
+        return;
+    }
+    if (state->origin == PostOrigin::Task) {
+        postLatencyProbe(state);
+        return;
+    }
+    uv_timer_start(&state->repost, [](uv_timer_t* timer) {
+        postLatencyProbe(static_cast<LatencyState*>(timer->data));
+    }, 0, 0);
+}
+
+gboolean onLegacyLatencyIdle(gpointer data)
+{
+    onLatencyProbe(static_cast<LatencyState*>(data));
+    return G_SOURCE_REMOVE;
+}
+
+void postLatencyProbe(LatencyState* state)
+{
+    state->postedAt = now();
+    if (state->path == PostPath::InvokeQueue)
+        state->harness->pump().invoke([state] { onLatencyProbe(state); });
+    else
+        postLegacy(onLegacyLatencyIdle, state);
+}
+
+std::string benchInvokeLatency(const Config& config, PostPath path, PostOrigin origin)
+{
+    const size_t warmup = 1000;
+    const size_t measured = config.quick ? 10000 : 100000;
+
+    PumpHarness harness;
+    LatencyState state { &harness, path, origin, warmup + measured };
+    state.samples.reserve(state.target);
+    uv_timer_init(harness.loop(), &state.repost);
+    state.repost.data = &state;
+
+    postLatencyProbe(&state);
+    const bool completed = harness.run(kRunTimeoutMs);
+    harness.closeHandle(reinterpret_cast<uv_handle_t*>(&state.repost));
+    const char* originName = origin == PostOrigin::Task ? "task" : "libuv";
+    if (!completed) {
+        fail(std::string("invoke_same_thread_latency/") + postPathName(path) + "/" + originName + " timed out");
+        flushLegacyPosts();
+    }
+
+    std::vector<int64_t> samples;
+    if (state.samples.size() > warmup)
+        samples.assign(state.samples.begin() + warmup, state.samples.end());
+    return JsonObject()
+        .string("name", "invoke_same_thread_latency")
+        .string("path", postPathName(path))
+        .string("postedFrom", originName)
+        .boolean("completed", completed)
+        .raw("latency", summarizeUs(std::move(samples)))
+        .str();
+}
+
+// ---- Dedicated WebKit thread round trip ----
+
+// WKRuntime's ThreadMode::Dedicated path: a task posted from the ArkTS thread
+// (a plain uv loop here) runs on WebKitThread and answers through a uv_async,
+// which is what napi_threadsafe_function uses underneath.
+struct RoundTripState {
+    uv_loop_t* loop;
+    WebKitThread* thread;
+    size_t target;
+    std::vector<int64_t> samples {};
+    uint64_t postedAt = 0;
+    uv_async_t reply {};
+};
+
+void postRoundTrip(RoundTripState* state)
+{
+    state->postedAt = now();
+    state->thread->invoke([state] { uv_async_send(&state->reply); });
+}
+
+void onRoundTripReply(uv_async_t* handle)
+{
+    auto* state = static_cast<RoundTripState*>(handle->data);
+    state->samples.push_back(static_cast<int64_t>(now() - state->postedAt));
+    if (state->samples.size() == state->target) {
+        uv_close(reinterpret_cast<uv_handle_t*>(handle), nullptr);
+        return;
+    }
+    postRoundTrip(state);
+}
+
+std::string benchWebKitThreadRoundTrip(const Config& config)
+{
+    const size_t warmup = 1000;
+    const size_t measured = config.quick ? 10000 : 100000;
+
+    uv_loop_t loop;
+    uv_loop_init(&loop);
+    WebKitThread thread;
+    RoundTripState state { &loop, &thread, warmup + measured };
+    state.samples.reserve(state.target);
+    uv_async_init(&loop, &state.reply, onRoundTripReply);
+    state.reply.data = &state;
+
+    postRoundTrip(&state);
+    uv_run(&loop, UV_RUN_DEFAULT);
+    uv_loop_close(&loop);
+
+    const bool completed = state.samples.size() == state.target;
+    if (!completed)
+        fail("webkit_thread_round_trip did not complete");
+
+    std::vector<int64_t> samples;
+    if (state.samples.size() > warmup)
+        samples.assign(state.samples.begin() + warmup, state.samples.end());
+    return JsonObject()
+        .string("name", "webkit_thread_round_trip")
+        .boolean("completed", completed)
+        .raw("latency", summarizeUs(std::move(samples)))
+        .str();
+}
+
+// ---- Invoke allocations ----
+
+struct AllocationState {
+    PumpHarness* harness;
+    size_t remaining = 0;
+};
+
+// Each probe captures the state pointer plus `PayloadSize` bytes, the shape
+// of a WKRuntime::Post lambda (an id, a window pointer, a size, ...).
+template<size_t PayloadSize>
+void postAllocationProbe(AllocationState* state)
+{
+    std::array<unsigned char, PayloadSize> payload {};
+    state->harness->pump().invoke([state, payload] {
+        (void)payload;
+        if (--state->remaining == 0)
+            state->harness->stop();
+        else
+            postAllocationProbe<PayloadSize>(state);
+    });
+}
+
+template<size_t PayloadSize>
+std::string benchInvokeAllocations(const Config& config, bool expectInline)
+{
+    const size_t posts = config.quick ? 10000 : 100000;
+    PumpHarness harness;
+    AllocationState state { &harness };
+
+    // Warm up first so one-time growth (loop internals, vectors) is excluded.
+    state.remaining = 1000;
+    postAllocationProbe<PayloadSize>(&state);
+    bool completed = harness.run(kRunTimeoutMs);
+
+    s_allocations.store(0, std::memory_order_relaxed);
+    s_countAllocations.store(true, std::memory_order_relaxed);
+    state.remaining = posts;
+    postAllocationProbe<PayloadSize>(&state);
+    completed = harness.run(kRunTimeoutMs) && completed;
+    s_countAllocations.store(false, std::memory_order_relaxed);
+    const uint64_t allocations = s_allocations.load(std::memory_order_relaxed);
+
+    const std::string name = "invoke_allocations/capture_" + std::to_string(PayloadSize + sizeof(void*));
+    if (!completed)
+        fail(name + " timed out");
+    if (expectInline && allocations != 0)
+        fail(name + ": inline-sized capture allocated " + std::to_string(allocations) + " times");
+
+    return JsonObject()
+        .string("name", "invoke_allocations")
+        .count("captureBytes", PayloadSize + sizeof(void*))
+        .count("inlineCapacity", InvokeTask::kInlineCapacity)
+        .count("posts", posts)
+        .boolean("completed", completed)
+        .count("allocations", allocations)
+        .number("allocationsPerPost", static_cast<double>(allocations) / static_cast<double>(posts))
+        .str();
+}
+
+// ---- Dispatch budget ----
+
+constexpr uint32_t kFloodBudgetUs = 1000;
+constexpr uint64_t kFloodTaskUs = 50;
+
+struct FloodState {
+    PumpHarness* harness = nullptr;
+    uint64_t total = 0;
+    uint64_t executed = 0;
+    bool ordered = true;
+    bool completed = false;
+    MessagePump::DispatchBudgetStats stats {};
+};
+
+// Floods a budgeted pump with more tasks than the ring holds, so the overflow
+// path is drained under the budget too. Each task keeps the thread busy for
+// kFloodTaskUs; one unbudgeted batch runs several times the budget. The
+// flood is queued before the loop runs, so that no producer thread competes
+// for the CPU during the measured check phases.
+FloodState runDispatchFlood(uint64_t posts)
+{
+    MessagePump::Options options;
+    options.dispatchBudgetUs = kFloodBudgetUs;
+    PumpHarness harness(options);
+    FloodState state { &harness, posts };
+
+    for (uint64_t n = 0; n < posts; ++n) {
+        harness.pump().invoke([target = &state, n] {
+            const uint64_t begin = now();
+            while (now() - begin < kFloodTaskUs * 1000) { }
+            if (n != target->executed)
+                target->ordered = false;
+            if (++target->executed == target->total)
+                target->harness->stop();
+        });
+    }
+    state.completed = harness.run(kRunTimeoutMs);
+    state.stats = harness.pump().dispatchBudgetStats();
+    state.harness = nullptr;
+    return state;
+}
+
+std::string benchDispatchBudget(const Config& config)
+{
+    const uint64_t posts = config.quick ? 4000 : 20000;
+    // One task may start just before the deadline; allow for it, but stay
+    // well under an unbudgeted batch. The host can still preempt the loop
+    // for longer than that, so the best of a few runs is judged.
+    const uint64_t overrunLimitUs = 2 * kFloodBudgetUs;
+    const unsigned maxAttempts = 3;
+
+    FloodState best = runDispatchFlood(posts);
+    unsigned attempts = 1;
+    while (best.completed && best.ordered && best.stats.maxOverrunUs > overrunLimitUs && attempts < maxAttempts) {
+        FloodState state = runDispatchFlood(posts);
+        ++attempts;
+        if (!state.completed || !state.ordered || state.stats.maxOverrunUs < best.stats.maxOverrunUs)
+            best = state;
+    }
+
+    if (!best.completed)
+        fail("dispatch_budget timed out");
+    if (!best.ordered)
+        fail("dispatch_budget: tasks ran out of order");
+    if (best.stats.yields == 0)
+        fail("dispatch_budget: the pump never yielded");
+    if (best.stats.maxOverrunUs > overrunLimitUs)
+        fail("dispatch_budget: a check phase took " + std::to_string(best.stats.maxOverrunUs) + " us");
+
+    return JsonObject()
+        .string("name", "dispatch_budget")
+        .count("budgetUs", kFloodBudgetUs)
+        .count("taskUs", kFloodTaskUs)
+        .count("posts", posts)
+        .count("executed", best.executed)
+        .boolean("completed", best.completed)
+        .boolean("ordered", best.ordered)
+        .count("attempts", attempts)
+        .count("checkPhases", best.stats.checkPhases)
+        .count("iterations", best.stats.iterations)
+        .count("yields", best.stats.yields)
+        .count("overruns", best.stats.overruns)
+        .count("maxOverrunUs", best.stats.maxOverrunUs)
+        .str();
+}
+
+// ---- Timer accuracy ----
+
+struct TimerState {
+    int64_t intervalNs;
+    size_t target;
+    std::vector<int64_t> lateness {};
+    uint64_t last = 0;
+    void (*done)(void*) = nullptr;
+    void* doneData = nullptr;
+};
+
+// Lateness is measured between consecutive dispatches: GLib re-arms a
+// repeating timeout relative to its dispatch time.
+gboolean onTimerProbe(gpointer data)
+{
+    auto* state = static_cast<TimerState*>(data);
+    const uint64_t time = now();
+    if (state->last != 0)
+        state->lateness.push_back(static_cast<int64_t>(time - state->last) - state->intervalNs);
+    state->last = time;
+    if (state->lateness.size() < state->target)
+        return G_SOURCE_CONTINUE;
+    state->done(state->doneData);
+    return G_SOURCE_REMOVE;
+}
+
+std::string timerResult(const char* driver, unsigned intervalMs, bool completed, TimerState& state)
+{
+    return JsonObject()
+        .string("name", "timer_accuracy")
+        .string("driver", driver)
+        .count("intervalMs", intervalMs)
+        .boolean("completed", completed)
+        .raw("lateness", summarizeUs(std::move(state.lateness)))
+        .str();
+}
+
+size_t timerSamples(const Config& config, unsigned intervalMs)
+{
+    const unsigned spanMs = config.quick ? 300 : 3000;
+    return std::max<size_t>(10, spanMs / intervalMs);
+}
+
+std::string benchTimerAccuracyPump(const Config& config, unsigned intervalMs)
+{
+    PumpHarness harness;
+    TimerState state { static_cast<int64_t>(intervalMs) * 1000000, timerSamples(config, intervalMs) };
+    state.done = [](void* data) { static_cast<PumpHarness*>(data)->stop(); };
+    state.doneData = &harness;
+
+    GSource* source = g_timeout_source_new(intervalMs);
+    g_source_set_callback(source, onTimerProbe, &state, nullptr);
+    g_source_attach(source, g_main_context_default());
+    const bool completed = harness.run(kRunTimeoutMs);
+    g_source_destroy(source);
+    g_source_unref(source);
+
+    if (!completed)
+        fail("timer_accuracy/message_pump/" + std::to_string(intervalMs) + "ms timed out");
+    return timerResult("message_pump", intervalMs, completed, state);
+}
+
+// Reference: the same timeout on a private context run by g_main_loop_run.
+std::string benchTimerAccuracyGLib(const Config& config, unsigned intervalMs)
+{
+    TimerState state { static_cast<int64_t>(intervalMs) * 1000000, timerSamples(config, intervalMs) };
+    bool completed = false;
+
+    std::thread([&state, &completed, intervalMs] {
+        GMainContext* context = g_main_context_new();
+        g_main_context_push_thread_default(context);
+        GMainLoop* loop = g_main_loop_new(context, FALSE);
+        state.done = [](void* data) { g_main_loop_quit(static_cast<GMainLoop*>(data)); };
+        state.doneData = loop;
+
+        GSource* source = g_timeout_source_new(intervalMs);
+        g_source_set_callback(source, onTimerProbe, &state, nullptr);
+        g_source_attach(source, context);
+        GSource* deadline = g_timeout_source_new(kRunTimeoutMs);
+        g_source_set_callback(deadline, [](gpointer data) -> gboolean {
+            g_main_loop_quit(static_cast<GMainLoop*>(data));
+            return G_SOURCE_REMOVE;
+        }, loop, nullptr);
+        g_source_attach(deadline, context);
+
+        g_main_loop_run(loop);
+        completed = state.lateness.size() == state.target;
+
+        g_source_destroy(deadline);
+        g_source_unref(deadline);
+        g_source_destroy(source);
+        g_source_unref(source);
+        g_main_loop_unref(loop);
+        g_main_context_pop_thread_default(context);
+        g_main_context_unref(context);
+    }).join();
+
+    if (!completed)
+        fail("timer_accuracy/g_main_loop/" + std::to_string(intervalMs) + "ms timed out");
+    return timerResult("g_main_loop", intervalMs, completed, state);
+}
+
+// ---- fd sources: dispatch cost and churn with many GLib fd sources ----
+
+struct FdState {
+    PumpHarness* harness;
+    size_t signalPerRound;
+    size_t churnPerRound;
+    size_t targetRounds;
+    // Churn moves sources between the active and spare sets, and replaces
+    // one active fd per round with a new eventfd under the same number (as
+    // WebKit IPC and socket churn does), which the pump must notice.
+    std::vector<int> fds {};
+    std::vector<GSource*> sources {};
+    std::vector<size_t> active {};
+    std::vector<size_t> spare {};
+    size_t signalCursor = 0;
+    size_t churnCursor = 0;
+    size_t reopenCursor = 0;
+    size_t pending = 0;
+    uint64_t roundStart = 0;
+    std::vector<int64_t> roundTimes {};
+};
+
+void startFdRound(FdState* state);
+
+void attachFdSource(FdState* state, size_t index);
+
+void finishFdRound(FdState* state)
+{
+    state->roundTimes.push_back(static_cast<int64_t>(now() - state->roundStart));
+
+    for (size_t i = 0; i < state->churnPerRound && !state->spare.empty(); ++i) {
+        const size_t activeSlot = state->churnCursor++ % state->active.size();
+        const size_t spareSlot = i % state->spare.size();
+        const size_t retired = state->active[activeSlot];
+        g_source_destroy(state->sources[retired]);
+        g_source_unref(state->sources[retired]);
+        state->sources[retired] = nullptr;
+        state->active[activeSlot] = state->spare[spareSlot];
+        attachFdSource(state, state->active[activeSlot]);
+        state->spare[spareSlot] = retired;
+    }
+
+    if (state->churnPerRound > 0) {
+        // dup2() closes the old eventfd, which drops it from any epoll set.
+        const size_t reopened = state->active[state->reopenCursor++ % state->active.size()];
+        g_source_destroy(state->sources[reopened]);
+        g_source_unref(state->sources[reopened]);
+        const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd >= 0) {
+            dup2(fd, state->fds[reopened]);
+            close(fd);
+        }
+        attachFdSource(state, reopened);
+    }
+
+    if (state->roundTimes.size() == state->targetRounds)
+        state->harness->stop();
+    else
+        startFdRound(state);
+}
+
+gboolean onFdReadable(gint fd, GIOCondition, gpointer data)
+{
+    uint64_t value;
+    if (read(fd, &value, sizeof(value)) != sizeof(value))
+        return G_SOURCE_CONTINUE;
+    auto* state = static_cast<FdState*>(data);
+    if (--state->pending == 0)
+        finishFdRound(state);
+    return G_SOURCE_CONTINUE;
+}
+
+void attachFdSource(FdState* state, size_t index)
+{
+    GSource* source = g_unix_fd_source_new(state->fds[index], G_IO_IN);
+    g_source_set_callback(source, reinterpret_cast<GSourceFunc>(reinterpret_cast<void (*)()>(onFdReadable)), state, nullptr);
+    g_source_attach(source, g_main_context_default());
+    state->sources[index] = source;
+}
+
+void startFdRound(FdState* state)
+{
+    state->roundStart = now();
+    state->pending = state->signalPerRound;
+    const uint64_t one = 1;
+    for (size_t i = 0; i < state->signalPerRound; ++i) {
+        const size_t index = state->active[state->signalCursor++ % state->active.size()];
+        if (write(state->fds[index], &one, sizeof(one)) != sizeof(one))
+            --state->pending;
+    }
+    if (state->pending == 0)
+        state->harness->stop();
+}
+
+std::string benchFdSources(const Config& config, MessagePump::PollMode mode, size_t fdCount, bool churn)
+{
+    const size_t warmupRounds = 10;
+    const size_t rounds = config.quick ? 200 : 2000;
+    const std::string name = std::string("fd_sources/") + pollModeName(mode) + "/" + std::to_string(fdCount)
+        + (churn ? "/churn" : "/steady");
+
+    MessagePump::Options options;
+    options.pollMode = mode;
+    PumpHarness harness(options);
+
+    FdState state { &harness, std::max<size_t>(1, fdCount / 10), churn ? std::max<size_t>(1, fdCount / 10) : 0,
+        warmupRounds + rounds };
+    const size_t spareCount = state.churnPerRound;
+    for (size_t i = 0; i < fdCount + spareCount; ++i) {
+        const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd < 0) {
+            fail(name + ": eventfd failed (" + std::strerror(errno) + ")");
+            break;
+        }
+        state.fds.push_back(fd);
+    }
+    state.sources.assign(state.fds.size(), nullptr);
+
+    bool completed = false;
+    uint64_t cpu = 0;
+    MessagePump::PollHandleStats churnStats;
+    if (state.fds.size() == fdCount + spareCount) {
+        for (size_t i = 0; i < fdCount; ++i) {
+            state.active.push_back(i);
+            attachFdSource(&state, i);
+        }
+        for (size_t i = fdCount; i < state.fds.size(); ++i)
+            state.spare.push_back(i);
+
+        harness.pump().invoke([target = &state] { startFdRound(target); });
+        const MessagePump::PollHandleStats before = harness.pump().pollHandleStats();
+        const uint64_t cpuBegin = threadCpuTime();
+        completed = harness.run(kRunTimeoutMs);
+        cpu = threadCpuTime() - cpuBegin;
+        const MessagePump::PollHandleStats& after = harness.pump().pollHandleStats();
+        churnStats.adds = after.adds - before.adds;
+        churnStats.removes = after.removes - before.removes;
+        churnStats.rearms = after.rearms - before.rearms;
+        churnStats.revalidations = after.revalidations - before.revalidations;
+        churnStats.readds = after.readds - before.readds;
+        if (!completed)
+            fail(name + " timed out");
+        // Churn reopens one fd per round; everything else kept must stay.
+        if (churnStats.readds > state.roundTimes.size())
+            fail(name + ": " + std::to_string(churnStats.readds) + " fds registered again in "
+                + std::to_string(state.roundTimes.size()) + " rounds");
+    }
+
+    for (GSource* source : state.sources) {
+        if (source != nullptr) {
+            g_source_destroy(source);
+            g_source_unref(source);
+        }
+    }
+    for (int fd : state.fds)
+        close(fd);
+
+    std::vector<int64_t> samples;
+    if (state.roundTimes.size() > warmupRounds)
+        samples.assign(state.roundTimes.begin() + warmupRounds, state.roundTimes.end());
+    const size_t measuredRounds = samples.size();
+    return JsonObject()
+        .string("name", "fd_sources")
+        .string("pollMode", pollModeName(mode))
+        .count("fds", fdCount)
+        .count("signaledPerRound", state.signalPerRound)
+        .count("churnPerRound", state.churnPerRound)
+        .boolean("completed", completed)
+        .raw("round", summarizeUs(std::move(samples)))
+        .number("cpuUsPerRound", state.roundTimes.empty() ? 0.0
+            : static_cast<double>(cpu) / 1000.0 / static_cast<double>(state.roundTimes.size()))
+        .count("measuredRounds", measuredRounds)
+        .raw("registrations", JsonObject()
+            .count("adds", churnStats.adds)
+            .count("removes", churnStats.removes)
+            .count("rearms", churnStats.rearms)
+            .count("revalidations", churnStats.revalidations)
+            .count("readds", churnStats.readds)
+            .str())
+        .str();
+}
+
+// ---- Stall watchdog ----
+
+gboolean onStallProbe(gpointer data)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(*static_cast<unsigned*>(data)));
+    return G_SOURCE_REMOVE;
+}
+
+std::string benchStallWatchdog(const Config& config)
+{
+    const unsigned thresholdMs = 100;
+    unsigned stallMs = 300;
+
+    // Heartbeat cost, paid by every dispatch while the watchdog is on.
+    const uint64_t beats = config.quick ? 1000000 : 10000000;
+    uint64_t heartbeatNs = 0;
+    {
+        StallWatchdog::Options options;
+        options.thresholdMs = thresholdMs;
+        StallWatchdog watchdog(options);
+        const uint64_t begin = now();
+        for (uint64_t i = 0; i < beats; ++i) {
+            watchdog.dispatchStarted();
+            watchdog.dispatchFinished();
+        }
+        heartbeatNs = now() - begin;
+    }
+
+    PumpHarness harness;
+    StallWatchdog::Options options;
+    options.thresholdMs = thresholdMs;
+    harness.pump().enableStallWatchdog(options);
+
+    GSource* probe = g_idle_source_new();
+    g_source_set_name(probe, "stall probe");
+    g_source_set_callback(probe, onStallProbe, &stallMs, nullptr);
+    g_source_attach(probe, g_main_context_default());
+    g_source_unref(probe);
+
+    // Stall, then give the watchdog a few checks to close the report.
+    harness.run(stallMs + 4 * thresholdMs);
+    const std::string reports = harness.pump().stallWatchdog()->toJson();
+
+    const bool detected = reports.find("\"source\":\"stall probe\"") != std::string::npos;
+    const bool captured = reports.find("\"captured\":true") != std::string::npos
+        && reports.find("\"backtrace\":[\"#00 pc ") != std::string::npos;
+    const bool finished = reports.find("\"finished\":true") != std::string::npos;
+    if (!detected || !captured || !finished)
+        fail("stall_watchdog: stall not reported: " + reports);
+
+    return JsonObject()
+        .string("name", "stall_watchdog")
+        .number("heartbeatNsPerDispatch", static_cast<double>(heartbeatNs) / static_cast<double>(beats))
+        .boolean("detected", detected)
+        .boolean("captured", captured)
+        .boolean("finished", finished)
+        .raw("reports", reports)
+        .str();
+}
+
+// ---- Idle wakeups ----
+
+gboolean onIdleTimer(gpointer data)
+{
+    ++*static_cast<uint64_t*>(data);
+    return G_SOURCE_CONTINUE;
+}
+
+enum class IdleScenario {
+    Empty,
+    // A quiet page still carries a few periodic timers (GC, memory sampling,
+    // caret blink); the ideal is one wakeup per expiry and nothing else.
+    PeriodicTimers,
+    // Many short, unrelated timers, as a page with a few JS intervals and
+    // WebKit's own housekeeping produces; what timer slack is meant for.
+    ManyTimers,
+};
+
+const char* idleScenarioName(IdleScenario scenario)
+{
+    switch (scenario) {
+    case IdleScenario::Empty:
+        return "empty";
+    case IdleScenario::PeriodicTimers:
+        return "periodic_timers";
+    case IdleScenario::ManyTimers:
+        return "many_timers";
+    }
+    return "unknown";
+}
+
+enum class SlackPolicy {
+    None,
+    // Options::timerSlackUs on a 4 ms grid.
+    Granularity4ms,
+    // Frame boundaries of a 60 Hz frame clock (setFrameTiming()).
+    Frame60Hz,
+};
+
+const char* slackPolicyName(SlackPolicy policy)
+{
+    switch (policy) {
+    case SlackPolicy::None:
+        return "none";
+    case SlackPolicy::Granularity4ms:
+        return "granularity_4ms";
+    case SlackPolicy::Frame60Hz:
+        return "frame_60hz";
+    }
+    return "unknown";
+}
+
+std::string benchIdleWakeups(const Config& config, MessagePump::PollMode mode, IdleScenario scenario,
+    SlackPolicy slack)
+{
+    static constexpr unsigned kPeriodicIntervalsMs[] = { 50, 200, 1000 };
+    static constexpr unsigned kManyIntervalsMs[] = { 7, 11, 13, 17, 23, 31, 50, 97, 200, 1000 };
+    const uint64_t durationMs = config.quick ? 1000 : 5000;
+
+    MessagePump::Options options;
+    options.pollMode = mode;
+    if (slack == SlackPolicy::Granularity4ms)
+        options.timerSlackUs = 4000;
+    else if (slack == SlackPolicy::Frame60Hz)
+        options.timerSlackUs = 16667;
+    PumpHarness harness(options);
+    if (slack == SlackPolicy::Frame60Hz)
+        harness.pump().setFrameTiming(g_get_monotonic_time(), 16667);
+
+    std::vector<unsigned> intervals;
+    if (scenario == IdleScenario::PeriodicTimers)
+        intervals.assign(std::begin(kPeriodicIntervalsMs), std::end(kPeriodicIntervalsMs));
+    else if (scenario == IdleScenario::ManyTimers)
+        intervals.assign(std::begin(kManyIntervalsMs), std::end(kManyIntervalsMs));
+
+    // Without slack, the ideal is one wakeup per expiry.
+    std::vector<GSource*> timers;
+    std::vector<uint64_t> fired(intervals.size(), 0);
+    double expectedWakeups = 0;
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        GSource* timer = g_timeout_source_new(intervals[i]);
+        g_source_set_callback(timer, onIdleTimer, &fired[i], nullptr);
+        g_source_attach(timer, g_main_context_default());
+        timers.push_back(timer);
+        expectedWakeups += static_cast<double>(durationMs) / intervals[i];
+    }
+
+    // Let the initial wakeup and registrations settle before measuring.
+    harness.run(50);
+    std::fill(fired.begin(), fired.end(), 0);
+    harness.pump().setStatsEnabled(true);
+    const uint64_t cpuBegin = threadCpuTime();
+    harness.run(durationMs);
+    const uint64_t cpu = threadCpuTime() - cpuBegin;
+    const MessagePumpStats& stats = *harness.pump().stats();
+    const double seconds = static_cast<double>(durationMs) / 1000.0;
+    uint64_t timerCallbacks = 0;
+    for (uint64_t count : fired)
+        timerCallbacks += count;
+
+    const std::string result = JsonObject()
+        .string("name", "idle_wakeups")
+        .string("pollMode", pollModeName(mode))
+        .string("scenario", idleScenarioName(scenario))
+        .string("timerSlack", slackPolicyName(slack))
+        .number("durationMs", static_cast<double>(durationMs))
+        .number("wakeupsPerSecond", static_cast<double>(stats.fdWakeups + stats.timerWakeups) / seconds)
+        .number("fdWakeupsPerSecond", static_cast<double>(stats.fdWakeups) / seconds)
+        .number("timerWakeupsPerSecond", static_cast<double>(stats.timerWakeups) / seconds)
+        .number("iterationsPerSecond", static_cast<double>(stats.iterations) / seconds)
+        .number("expectedWakeupsPerSecond", expectedWakeups / seconds)
+        .number("timerCallbacksPerSecond", static_cast<double>(timerCallbacks) / seconds)
+        .number("cpuPercent", static_cast<double>(cpu) / 1e7 / seconds)
+        .str();
+
+    for (GSource* timer : timers) {
+        g_source_destroy(timer);
+        g_source_unref(timer);
+    }
+    return result;
+}
+
+void raiseFdLimit()
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+size_t fdLimit()
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY)
+        return SIZE_MAX;
+    return static_cast<size_t>(limit.rlim_cur);
+}
+
+bool parseArguments(int argc, char** argv, Config& config)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* argument = argv[i];
+        if (std::strcmp(argument, "--quick") == 0)
+            config.quick = true;
+        else if (std::strncmp(argument, "--filter=", 9) == 0)
+            config.filter = argument + 9;
+        else if (std::strncmp(argument, "--output=", 9) == 0)
+            config.output = argument + 9;
+        else
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Config config;
+    if (!parseArguments(argc, argv, config)) {
+        std::fprintf(stderr, "usage: %s [--quick] [--filter=<text>] [--output=<path>]\n", argv[0]);
+        return 2;
+    }
+    raiseFdLimit();
+
+    std::vector<std::string> results;
+    auto run = [&config, &results](const std::string& name, auto&& benchmark) {
+        if (!config.filter.empty() && name.find(config.filter) == std::string::npos)
+            return;
+        std::fprintf(stderr, "running %s\n", name.c_str());
+        results.push_back(benchmark());
+    };
+
+    for (PostPath path : { PostPath::InvokeQueue, PostPath::LegacyIdleSource }) {
+        for (unsigned producers : { 1u, 4u }) {
+            run(std::string("invoke_cross_thread_throughput/") + postPathName(path) + "/" + std::to_string(producers),
+                [&] { return benchInvokeThroughput(config, path, producers); });
+        }
+        for (PostOrigin origin : { PostOrigin::Task, PostOrigin::Libuv }) {
+            run(std::string("invoke_same_thread_latency/") + postPathName(path)
+                    + (origin == PostOrigin::Task ? "/task" : "/libuv"),
+                [&] { return benchInvokeLatency(config, path, origin); });
+        }
+    }
+
+    run("webkit_thread_round_trip", [&] { return benchWebKitThreadRoundTrip(config); });
+
+    run("stall_watchdog", [&] { return benchStallWatchdog(config); });
+
+    run("invoke_allocations/inline", [&] { return benchInvokeAllocations<48>(config, true); });
+    run("invoke_allocations/heap", [&] { return benchInvokeAllocations<96>(config, false); });
+
+    run("dispatch_budget", [&] { return benchDispatchBudget(config); });
+
+    for (unsigned intervalMs : { 1u, 4u, 16u, 50u }) {
+        run("timer_accuracy/message_pump/" + std::to_string(intervalMs) + "ms",
+            [&] { return benchTimerAccuracyPump(config, intervalMs); });
+        run("timer_accuracy/g_main_loop/" + std::to_string(intervalMs) + "ms",
+            [&] { return benchTimerAccuracyGLib(config, intervalMs); });
+    }
+
+    std::vector<size_t> fdCounts { 10, 100, 1000 };
+    if (!config.quick)
+        fdCounts.push_back(4000);
+    for (MessagePump::PollMode mode : { MessagePump::PollMode::PerFd, MessagePump::PollMode::Epoll }) {
+        for (size_t fdCount : fdCounts) {
+            // Each fd costs one eventfd, plus a spare for churn and libuv's own.
+            if (fdCount + fdCount / 10 + 64 > fdLimit()) {
+                std::fprintf(stderr, "skipping %zu fds: RLIMIT_NOFILE too low\n", fdCount);
+                continue;
+            }
+            for (bool churn : { false, true }) {
+                run(std::string("fd_sources/") + pollModeName(mode) + "/" + std::to_string(fdCount)
+                        + (churn ? "/churn" : "/steady"),
+                    [&] { return benchFdSources(config, mode, fdCount, churn); });
+            }
+        }
+        for (IdleScenario scenario : { IdleScenario::Empty, IdleScenario::PeriodicTimers, IdleScenario::ManyTimers }) {
+            run(std::string("idle_wakeups/") + pollModeName(mode) + "/" + idleScenarioName(scenario),
+                [&] { return benchIdleWakeups(config, mode, scenario, SlackPolicy::None); });
+        }
+    }
+
+    // Slack only changes how the timer is armed, not how fds are watched.
+    for (SlackPolicy slack : { SlackPolicy::Granularity4ms, SlackPolicy::Frame60Hz }) {
+        for (IdleScenario scenario : { IdleScenario::PeriodicTimers, IdleScenario::ManyTimers }) {
+            run(std::string("idle_wakeups/per_fd/") + idleScenarioName(scenario) + "/slack_" + slackPolicyName(slack),
+                [&] { return benchIdleWakeups(config, MessagePump::PollMode::PerFd, scenario, slack); });
+        }
+    }
+
+    std::string failures = "[";
+    for (size_t i = 0; i < s_failures.size(); ++i) {
+        if (i > 0)
+            failures += ',';
+        failures += '"' + s_failures[i] + '"';
+    }
+    failures += ']';
+
+    std::string resultList = "[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (i > 0)
+            resultList += ',';
+        resultList += results[i];
+    }
+    resultList += ']';
+
+    const std::string document = JsonObject()
+        .string("suite", "message_pump")
+        .count("schemaVersion", 1)
+        .boolean("quick", config.quick)
+        .raw("host", JsonObject()
+            .count("cpus", std::thread::hardware_concurrency())
+            .string("glib", std::to_string(glib_major_version) + "." + std::to_string(glib_minor_version) + "."
+                + std::to_string(glib_micro_version))
+            .string("libuv", uv_version_string())
+            .str())
+        .raw("results", resultList)
+        .raw("failures", failures)
+        .str() + "\n";
+
+    FILE* out = config.output.empty() ? stdout : std::fopen(config.output.c_str(), "w");
+    if (out == nullptr) {
+        std::fprintf(stderr, "cannot open %s: %s\n", config.output.c_str(), std::strerror(errno));
+        return 2;
+    }
+    std::fputs(document.c_str(), out);
+    if (out != stdout)
+        std::fclose(out);
+    return s_failures.empty() ? 0 : 1;
+}
@@ -19,15 +19,102 @@
 #include <epoxy/egl.h>
 #include <uv.h>
 
+#include <string>
+
 #include "common/log.h"
 #include "runtime/wk_runtime.h"
 #include "runtime/wk_web_view.h"
 
+namespace {
+
+bool GetStringProperty(napi_env env, napi_value object, const char* name, std::string& out)
+{
+    bool has = false;
+    if (napi_has_named_property(env, object, name, &has) != napi_ok || !has)
+        return false;
+
+    napi_value value;
+    size_t length = 0;
+    if (napi_get_named_property(env, object, name, &value) != napi_ok
+        || napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok)
+        return false;
+
+    out.resize(length);
+    return napi_get_value_string_utf8(env, value, out.data(), length + 1, &length) == napi_ok;
+}
+
+bool GetBoolProperty(napi_env env, napi_value object, const char* name, bool& out)
+{
+    bool has = false;
+    napi_value value;
+    return napi_has_named_property(env, object, name, &has) == napi_ok && has
+        && napi_get_named_property(env, object, name, &value) == napi_ok
+        && napi_get_value_bool(env, value, &out) == napi_ok;
+}
+
+bool GetUint32Property(napi_env env, napi_value object, const char* name, uint32_t& out)
+{
+    bool has = false;
+    napi_value value;
+    return napi_has_named_property(env, object, name, &has) == napi_ok && has
+        && napi_get_named_property(env, object, name, &value) == napi_ok
+        && napi_get_value_uint32(env, value, &out) == napi_ok;
+}
+
+// init(options?: { threadMode?: 'main' | 'dedicated', pollMode?: 'perFd' | 'epoll',
+//                  dispatchBudgetUs?: number, timerSlackUs?: number, stallThresholdMs?: number,
+//                  prewarm?: 'none' | 'processes' | 'blankPage', webViewPoolSize?: number,
+//                  directPresent?: boolean, memoryPressureIntervalMs?: number, memoryPressureNonCriticalPct?: number,
+//                  memoryPressureCriticalPct?: number })
+WKRuntime::Options ParseRuntimeOptions(napi_env env, napi_value object)
+{
+    WKRuntime::Options options;
+
+    napi_valuetype type = napi_undefined;
+    if (object == nullptr || napi_typeof(env, object, &type) != napi_ok || type != napi_object)
+        return options;
+
+    std::string value;
+    if (GetStringProperty(env, object, "threadMode", value)) {
+        if (value == "dedicated")
+            options.threadMode = WKRuntime::ThreadMode::Dedicated;
+        else if (value != "main")
+            LOGE("Init: unknown threadMode '%{public}s'", value.c_str());
+    }
+    if (GetStringProperty(env, object, "pollMode", value)) {
+        if (value == "epoll")
+            options.pump.pollMode = MessagePump::PollMode::Epoll;
+        else if (value != "perFd")
+            LOGE("Init: unknown pollMode '%{public}s'", value.c_str());
+    }
+
+    if (GetStringProperty(env, object, "prewarm", value)) {
+        if (value == "processes")
+            options.prewarm = ProcessPrewarmer::Mode::Processes;
+        else if (value == "blankPage")
+            options.prewarm = ProcessPrewarmer::Mode::BlankPage;
+        else if (value != "none")
+            LOGE("Init: unknown prewarm '%{public}s'", value.c_str());
+    }
+
+    GetUint32Property(env, object, "dispatchBudgetUs", options.pump.dispatchBudgetUs);
+    GetUint32Property(env, object, "timerSlackUs", options.pump.timerSlackUs);
+    GetUint32Property(env, object, "stallThresholdMs", options.stallThresholdMs);
+    GetUint32Property(env, object, "webViewPoolSize", options.webViewPoolSize);
+    GetBoolProperty(env, object, "directPresent", options.directPresent);
+    GetUint32Property(env, object, "memoryPressureIntervalMs", options.memoryPressureIntervalMs);
+    GetUint32Property(env, object, "memoryPressureNonCriticalPct", options.memoryPressure.nonCriticalUsedPct);
+    GetUint32Property(env, object, "memoryPressureCriticalPct", options.memoryPressure.criticalUsedPct);
+
+    return options;
+}
+
+} // namespace
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-
 static napi_value NapiInit(napi_env env, napi_callback_info info)
 {
     LOGD("Init");
@@ -36,9 +123,11 @@ static napi_value NapiInit(napi_env env, napi_callback_info info)
         return nullptr;
     }
 
+    size_t argc = 1;
+    napi_value args[1] = { nullptr };
     napi_value thisArg;
-    if (napi_get_cb_info(env, info, nullptr, nullptr, &thisArg, nullptr) != napi_ok) {
-        LOGE("Init: napi_get_cb_info fail"); 
+    if (napi_get_cb_info(env, info, &argc, args, &thisArg, nullptr) != napi_ok) {
+        LOGE("Init: napi_get_cb_info fail");
         return nullptr;
     }
 
@@ -54,8 +143,17 @@ static napi_value NapiInit(napi_env env, napi_callback_info info)
         return nullptr;
     }
 
-    auto id = WKRuntime::GetXComponentId(nativeXComponent);
-    WKRuntime::RequestWebViewInit(id);
+    // Start WebKit on first init(), so the app can choose the thread mode.
+    // Must run on the app main env: calling init() from a Worker first would
+    // bind WebKit's GLib context to that worker's loop.
+    uv_loop_t* loop = nullptr;
+    if (napi_get_uv_event_loop(env, &loop) != napi_ok || loop == nullptr) {
+        LOGE("Init: failed to get libuv event loop");
+        return nullptr;
+    }
+    WKRuntime::Initialize(env, loop, ParseRuntimeOptions(env, argc > 0 ? args[0] : nullptr));
+
+    WKRuntime::RequestWebViewInit(WKRuntime::GetViewHandle(nativeXComponent));
 
     return nullptr;
 }
@@ -70,19 +168,7 @@ static napi_value Init(napi_env env, napi_value exports)
     };
     napi_define_properties(env, exports, sizeof(desc) / sizeof(desc[0]), desc);
 
-    // Drive WebKit's GLib run loop from this (the ArkTS) thread's libuv loop.
-    // Must run on the app main env: importing the module from a Worker first
-    // would bind WebKit's main thread to that worker thread.
-    bool ret = true;
-    uv_loop_t* loop = nullptr;
-    if (napi_get_uv_event_loop(env, &loop) != napi_ok || loop == nullptr) {
-        LOGE("Init: failed to get libuv event loop");
-        ret = false;
-    } else {
-        WKRuntime::Initialize(loop);
-    }
-
-    ret &= WKRuntime::Export(env, exports);
+    bool ret = WKRuntime::Export(env, exports);
     ret &= WKWebView::Export(env, exports);
     if (!ret) {
         LOGE("Init failed");
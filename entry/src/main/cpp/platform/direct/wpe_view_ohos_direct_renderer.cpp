@@ -0,0 +1,211 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#include "platform/direct/wpe_view_ohos_direct_renderer.h"
+
+#include "log.h"
+
+#include <algorithm>
+#include <unistd.h>
+
+WPEViewOHOSDirectRenderer::~WPEViewOHOSDirectRenderer()
+{
+    DetachAllBuffers();
+}
+
+void WPEViewOHOSDirectRenderer::Cleanup()
+{
+    DetachAllBuffers();
+    WPEViewOHOSGLES3Renderer::Cleanup();
+}
+
+bool WPEViewOHOSDirectRenderer::SetSurface(OHNativeWindow* nativeWindow, int width, int height)
+{
+    // The base class releases the old surface first, through ReleaseSurface().
+    bool created = WPEViewOHOSGLES3Renderer::SetSurface(nativeWindow, width, height);
+    window_ = nativeWindow;
+    surfaceWidth_ = width;
+    surfaceHeight_ = height;
+    return created;
+}
+
+void WPEViewOHOSDirectRenderer::ReleaseSurface()
+{
+    DetachAllBuffers();
+    window_ = nullptr;
+    WPEViewOHOSGLES3Renderer::ReleaseSurface();
+}
+
+void WPEViewOHOSDirectRenderer::Resize(int width, int height)
+{
+    surfaceWidth_ = width;
+    surfaceHeight_ = height;
+    WPEViewOHOSGLES3Renderer::Resize(width, height);
+}
+
+bool WPEViewOHOSDirectRenderer::PresentBuffer(OH_NativeBuffer* nativeBuffer, int acquireFenceFd, const Damage& damage)
+{
+    if (disabled_ || window_ == nullptr || nativeBuffer == nullptr)
+        return false;
+    // Presented again (after a resize or while hidden) while the window
+    // still shows it: nothing new to show. A resize brings a new buffer.
+    for (const auto& entry : flushed_) {
+        if (entry.nativeBuffer == nativeBuffer) {
+            if (acquireFenceFd >= 0)
+                close(acquireFenceFd);
+            return true;
+        }
+    }
+    // Stretching to a new surface size needs the GL path.
+    if (damage.bufferWidth != surfaceWidth_ || damage.bufferHeight != surfaceHeight_)
+        return false;
+
+    // From here on the queue holds only the window's buffers and ours.
+    DestroyWindowSurface();
+    ReclaimBuffers();
+
+    auto* windowBuffer = OH_NativeWindow_CreateNativeWindowBufferFromNativeBuffer(nativeBuffer);
+    if (windowBuffer == nullptr) {
+        Disable("OH_NativeWindow_CreateNativeWindowBufferFromNativeBuffer failed");
+        return false;
+    }
+    if (OH_NativeWindow_NativeWindowAttachBuffer(window_, windowBuffer) != 0) {
+        OH_NativeWindow_DestroyNativeWindowBuffer(windowBuffer);
+        Disable("OH_NativeWindow_NativeWindowAttachBuffer failed");
+        return false;
+    }
+
+    // Only the damaged part needs recompositing; no rects means all of it.
+    Region::Rect rect { damage.x, damage.y, static_cast<uint32_t>(damage.width), static_cast<uint32_t>(damage.height) };
+    Region region { nullptr, 0 };
+    if (damage.width > 0 && damage.height > 0)
+        region = { &rect, 1 };
+
+    // The window takes the fence it is given, so it gets a duplicate and
+    // the caller's stays valid should the flush fail.
+    int flushFenceFd = acquireFenceFd >= 0 ? dup(acquireFenceFd) : -1;
+    if (OH_NativeWindow_NativeWindowFlushBuffer(window_, windowBuffer, flushFenceFd, region) != 0) {
+        OH_NativeWindow_NativeWindowDetachBuffer(window_, windowBuffer);
+        OH_NativeWindow_DestroyNativeWindowBuffer(windowBuffer);
+        Disable("OH_NativeWindow_NativeWindowFlushBuffer failed");
+        return false;
+    }
+    if (acquireFenceFd >= 0)
+        close(acquireFenceFd);
+
+    flushed_.push_back({ nativeBuffer, windowBuffer });
+    return true;
+}
+
+int WPEViewOHOSDirectRenderer::Render(EGLImage image, int acquireFenceFd, const Damage& damage)
+{
+    if (window_ != nullptr && !HasWindowSurface()) {
+        // Back to the GL path. EGL requests buffers from the queue as soon
+        // as it has a surface, so the buffers the window has not given back
+        // yet can no longer be requested here; they stay attached, and out
+        // of WebKit's hands, until direct presentation resumes or the
+        // surface goes.
+        ReclaimBuffers();
+        stranded_.insert(stranded_.end(), flushed_.begin(), flushed_.end());
+        flushed_.clear();
+        CreateWindowSurface();
+    }
+    return WPEViewOHOSGLES3Renderer::Render(image, acquireFenceFd, damage);
+}
+
+void WPEViewOHOSDirectRenderer::TakeReleasedBuffers(std::vector<ReleasedBuffer>& released)
+{
+    released.insert(released.end(), released_.begin(), released_.end());
+    released_.clear();
+}
+
+void WPEViewOHOSDirectRenderer::ReclaimBuffers()
+{
+    // The newest flushed buffer is on screen until a later one replaces it.
+    if (window_ == nullptr || HasWindowSurface() || (flushed_.size() < 2 && stranded_.empty()))
+        return;
+
+    // The queue hands out the buffers the compositor is done with, so request
+    // as many as it holds, without waiting, and keep ours. The rest (the
+    // window's own, left by EGL or allocated by the queue) go back unused;
+    // with no EGL surface nobody else requests them.
+    int32_t queueSize = 0;
+    int32_t timeoutMs = 0;
+    if (OH_NativeWindow_NativeWindowHandleOpt(window_, GET_BUFFERQUEUE_SIZE, &queueSize) != 0
+        || OH_NativeWindow_NativeWindowHandleOpt(window_, GET_TIMEOUT, &timeoutMs) != 0)
+        return;
+    OH_NativeWindow_NativeWindowHandleOpt(window_, SET_TIMEOUT, 0);
+
+    auto take = [this](auto& buffers, OH_NativeBuffer* nativeBuffer, int releaseFenceFd) {
+        auto it = std::find_if(buffers.begin(), buffers.end(),
+            [nativeBuffer](const FlushedBuffer& entry) { return entry.nativeBuffer == nativeBuffer; });
+        if (it == buffers.end())
+            return false;
+        OH_NativeWindow_NativeWindowDetachBuffer(window_, it->windowBuffer);
+        OH_NativeWindow_DestroyNativeWindowBuffer(it->windowBuffer);
+        released_.push_back({ it->nativeBuffer, releaseFenceFd });
+        buffers.erase(it);
+        return true;
+    };
+
+    std::vector<OHNativeWindowBuffer*> others;
+    for (int32_t i = 0; i < queueSize && (flushed_.size() > 1 || !stranded_.empty()); ++i) {
+        OHNativeWindowBuffer* windowBuffer = nullptr;
+        int releaseFenceFd = -1;
+        if (OH_NativeWindow_NativeWindowRequestBuffer(window_, &windowBuffer, &releaseFenceFd) != 0)
+            break;
+
+        OH_NativeBuffer* nativeBuffer = nullptr;
+        OH_NativeBuffer_FromNativeWindowBuffer(windowBuffer, &nativeBuffer);
+        if (take(flushed_, nativeBuffer, releaseFenceFd) || take(stranded_, nativeBuffer, releaseFenceFd))
+            continue;
+        if (releaseFenceFd >= 0)
+            close(releaseFenceFd);
+        others.push_back(windowBuffer);
+    }
+
+    for (auto* windowBuffer : others)
+        OH_NativeWindow_NativeWindowAbortBuffer(window_, windowBuffer);
+    OH_NativeWindow_NativeWindowHandleOpt(window_, SET_TIMEOUT, timeoutMs);
+}
+
+void WPEViewOHOSDirectRenderer::DetachAllBuffers()
+{
+    auto detach = [this](const FlushedBuffer& entry) {
+        if (window_ != nullptr)
+            OH_NativeWindow_NativeWindowDetachBuffer(window_, entry.windowBuffer);
+        OH_NativeWindow_DestroyNativeWindowBuffer(entry.windowBuffer);
+    };
+    std::for_each(flushed_.begin(), flushed_.end(), detach);
+    std::for_each(stranded_.begin(), stranded_.end(), detach);
+    flushed_.clear();
+    stranded_.clear();
+    for (const auto& entry : released_) {
+        if (entry.releaseFenceFd >= 0)
+            close(entry.releaseFenceFd);
+    }
+    released_.clear();
+}
+
+void WPEViewOHOSDirectRenderer::Disable(const char* reason)
+{
+    // Render() takes over, and recreates the EGL surface.
+    LOGE("Direct presentation disabled, using the GLES3 path: %{public}s", reason);
+    disabled_ = true;
+}
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+#include "platform/gles3/wpe_view_ohos_gles3_renderer.h"
+
+// Presents WebKit's buffers by attaching them to the native window and
+// flushing them with their rendering fence, which saves the full-surface
+// copy the GLES3 renderer makes. A new buffer that does not fit the surface
+// (a resize in progress), and every frame after the window refuses a
+// buffer, go through the GLES3 path.
+//
+// The window's buffer queue is never shared with EGL: the EGL window surface
+// is destroyed before the first buffer is attached, and only recreated when
+// a frame needs the GLES3 path. A flushed buffer stays attached until the
+// window hands it back through its queue (OH_NativeWindow_NativeWindowRequestBuffer),
+// which it does once the compositor has released it, with the compositor's
+// release fence; only then does TakeReleasedBuffers() return it. Requesting
+// is only safe while EGL has no surface on the queue, so the buffers still
+// attached when the GLES3 path takes over wait, unused by WebKit, until
+// direct presentation resumes or the surface goes.
+//
+// Not validated on a device yet: it has only been built against the SDK
+// headers. Until a device run confirms that the window keeps showing the
+// last EGL frame across eglDestroySurface(), that attach/flush/request work
+// on an XComponent window and that no buffer goes back to WebKit while on
+// screen, it stays opt-in (WKRuntime's directPresent, off by default).
+class WPEViewOHOSDirectRenderer final : public WPEViewOHOSGLES3Renderer {
+public:
+    WPEViewOHOSDirectRenderer() = default;
+    ~WPEViewOHOSDirectRenderer();
+
+    void Cleanup() override;
+
+    bool SetSurface(OHNativeWindow* nativeWindow, int width, int height) override;
+    void ReleaseSurface() override;
+    void Resize(int width, int height) override;
+
+    int Render(EGLImage image, int acquireFenceFd, const Damage& damage) override;
+    bool PresentBuffer(OH_NativeBuffer* nativeBuffer, int acquireFenceFd, const Damage& damage) override;
+    void TakeReleasedBuffers(std::vector<ReleasedBuffer>& released) override;
+
+private:
+    struct FlushedBuffer {
+        OH_NativeBuffer* nativeBuffer;
+        OHNativeWindowBuffer* windowBuffer;
+    };
+
+    // Detaches the flushed and stranded buffers the window has given back.
+    // Only while there is no EGL surface.
+    void ReclaimBuffers();
+    void DetachAllBuffers();
+    void Disable(const char* reason);
+
+    OHNativeWindow* window_ = nullptr;
+    int surfaceWidth_ = 0;
+    int surfaceHeight_ = 0;
+    bool disabled_ = false;
+
+    // Buffers flushed to window_ and not yet given back, oldest first; those
+    // still attached when the GLES3 path took over; and the ones given back
+    // since the last TakeReleasedBuffers().
+    std::deque<FlushedBuffer> flushed_;
+    std::vector<FlushedBuffer> stranded_;
+    std::vector<ReleasedBuffer> released_;
+};
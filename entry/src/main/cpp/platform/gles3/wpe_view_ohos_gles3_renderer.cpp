@@ -19,27 +19,73 @@
 #include "platform/gles3/wpe_view_ohos_gles3_renderer.h"
 
 #include "log.h"
+#include "runtime/startup_trace.h"
 
+#include <atomic>
+#include <algorithm>
+#include <cstring>
 #include <unistd.h>
 
 namespace {
-static const char* s_vertexShaderSource = 
-    "attribute vec2 pos;\n"
-    "attribute vec2 texture;\n"
-    "varying vec2 v_texture;\n"
+// Attribute locations are fixed in the shader, so nothing is looked up
+// per frame.
+constexpr GLuint kPositionLocation = 0;
+constexpr GLuint kTexCoordLocation = 1;
+
+static const char* s_vertexShaderSource =
+    "#version 300 es\n"
+    "layout(location = 0) in vec2 pos;\n"
+    "layout(location = 1) in vec2 texCoord;\n"
+    "out vec2 v_texCoord;\n"
     "void main() {\n"
-    "  v_texture = texture;\n"
+    "  v_texCoord = texCoord;\n"
     "  gl_Position = vec4(pos, 0, 1);\n"
     "}\n";
 
 static const char* s_fragmentShaderSource =
+    "#version 300 es\n"
     "precision mediump float;\n"
     "uniform sampler2D u_texture;\n"
-    "varying vec2 v_texture;\n"
+    "in vec2 v_texCoord;\n"
+    "out vec4 fragColor;\n"
     "void main() {\n"
-    "  gl_FragColor = texture2D(u_texture, v_texture);\n"
+    "  fragColor = texture(u_texture, v_texCoord);\n"
     "}\n";
 
+// The full-viewport quad as a triangle strip: x, y, u, v per vertex.
+static const GLfloat s_quadVertices[] = {
+    -1,  1, 0, 0,
+     1,  1, 1, 0,
+    -1, -1, 0, 1,
+     1, -1, 1, 1,
+};
+
+// Buffer ages beyond this are redrawn in full; swapchains have 2-3 buffers.
+constexpr size_t kMaxBufferAge = 4;
+
+std::atomic<uint64_t> s_frames { 0 };
+std::atomic<uint64_t> s_pixelsDrawn { 0 };
+std::atomic<uint64_t> s_surfacePixels { 0 };
+
+bool HasExtension(const char* extensions, const char* name)
+{
+    if (!extensions)
+        return false;
+    const size_t length = strlen(name);
+    for (const char* match = strstr(extensions, name); match; match = strstr(match + length, name)) {
+        if ((match == extensions || match[-1] == ' ') && (match[length] == ' ' || match[length] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+// glGetError() can stall the pipeline on some drivers, so release builds
+// do not check.
+#ifdef NDEBUG
+inline void CheckGLError(const char*)
+{
+}
+#else
 void CheckGLError(const char* label)
 {
     GLenum err;
@@ -58,6 +104,7 @@ void CheckGLError(const char* label)
         LOGE("GL error at %{public}s: 0x%{public}x (%{public}s)", label, err, errStr);
     }
 }
+#endif
 
 }
 
@@ -76,38 +123,157 @@ bool WPEViewOHOSGLES3Renderer::Initialize(OHNativeWindow* nativeWindow, int widt
     width_ = width;
     height_ = height;
 
+    STARTUP_TRACE_SCOPE("WPEViewOHOSGLES3Renderer::InitializeEGL");
     return InitializeEGL();
 }
 
 void WPEViewOHOSGLES3Renderer::Cleanup()
 {
-    if (eglDisplay_ != EGL_NO_DISPLAY) {
-        eglMakeCurrent(eglDisplay_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
-        if (eglContext_ != EGL_NO_CONTEXT) {
-            eglDestroyContext(eglDisplay_, eglContext_);
-            eglContext_ = EGL_NO_CONTEXT;
-        }
-        if (eglSurface_ != EGL_NO_SURFACE) {
-            eglDestroySurface(eglDisplay_, eglSurface_);
-            eglSurface_ = EGL_NO_SURFACE;
-        }
-        eglTerminate(eglDisplay_);
-        eglDisplay_ = EGL_NO_DISPLAY;
+    if (eglDisplay_ == EGL_NO_DISPLAY)
+        return;
+
+    // The GL objects go with the context, but delete them while it is
+    // current when there is a surface to make it current with.
+    if (eglContext_ != EGL_NO_CONTEXT && eglSurface_ != EGL_NO_SURFACE
+        && eglMakeCurrent(eglDisplay_, eglSurface_, eglSurface_, eglContext_)) {
+        if (programHandle_)
+            glDeleteProgram(programHandle_);
+        DeleteReleasedTextures();
+        for (auto& entry : textures_)
+            glDeleteTextures(1, &entry.second);
+        if (vertexArray_)
+            glDeleteVertexArrays(1, &vertexArray_);
+        if (vertexBuffer_)
+            glDeleteBuffers(1, &vertexBuffer_);
     }
-    if (programHandle_) {
-        glDeleteProgram(programHandle_);
-        programHandle_ = 0;
+    programHandle_ = 0;
+    textures_.clear();
+    releasedTextures_.clear();
+    vertexArray_ = 0;
+    vertexBuffer_ = 0;
+
+    ReleaseSurface();
+    if (eglContext_ != EGL_NO_CONTEXT) {
+        eglDestroyContext(eglDisplay_, eglContext_);
+        eglContext_ = EGL_NO_CONTEXT;
     }
-    if (texture_) {
-        glDeleteTextures(1, &texture_);
-        texture_ = 0;
+    // No eglTerminate: EGL_DEFAULT_DISPLAY is one per process and other
+    // views' renderers are still using it.
+    eglDisplay_ = EGL_NO_DISPLAY;
+}
+
+bool WPEViewOHOSGLES3Renderer::SetSurface(OHNativeWindow* nativeWindow, int width, int height)
+{
+    ReleaseSurface();
+    if (eglContext_ == EGL_NO_CONTEXT)
+        return false;
+
+    nativeWindow_ = nativeWindow;
+    width_ = width;
+    height_ = height;
+    return CreateWindowSurface();
+}
+
+void WPEViewOHOSGLES3Renderer::ReleaseSurface()
+{
+    DestroyWindowSurface();
+    nativeWindow_ = nullptr;
+}
+
+bool WPEViewOHOSGLES3Renderer::CreateWindowSurface()
+{
+    if (eglSurface_ != EGL_NO_SURFACE)
+        return true;
+    if (eglContext_ == EGL_NO_CONTEXT || nativeWindow_ == nullptr)
+        return false;
+
+    damageHistory_.clear();
+    EGLNativeWindowType eglWindow = reinterpret_cast<EGLNativeWindowType>(nativeWindow_);
+    eglSurface_ = eglCreateWindowSurface(eglDisplay_, eglConfig_, eglWindow, nullptr);
+    if (eglSurface_ == EGL_NO_SURFACE) {
+        LOGE("Failed to create EGL window surface");
+        return false;
+    }
+
+    if (!eglMakeCurrent(eglDisplay_, eglSurface_, eglSurface_, eglContext_)) {
+        LOGE("Failed to make EGL context current");
+        return false;
+    }
+    return true;
+}
+
+void WPEViewOHOSGLES3Renderer::DestroyWindowSurface()
+{
+    if (eglSurface_ == EGL_NO_SURFACE)
+        return;
+    eglMakeCurrent(eglDisplay_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroySurface(eglDisplay_, eglSurface_);
+    eglSurface_ = EGL_NO_SURFACE;
+}
+
+void WPEViewOHOSGLES3Renderer::Resize(int width, int height)
+{
+    width_ = width;
+    height_ = height;
+    damageHistory_.clear();
+}
+
+void WPEViewOHOSGLES3Renderer::GetPixelStats(uint64_t* frames, uint64_t* pixelsDrawn, uint64_t* surfacePixels)
+{
+    *frames = s_frames.load(std::memory_order_relaxed);
+    *pixelsDrawn = s_pixelsDrawn.load(std::memory_order_relaxed);
+    *surfacePixels = s_surfacePixels.load(std::memory_order_relaxed);
+}
+
+WPEViewOHOSGLES3Renderer::Rect WPEViewOHOSGLES3Renderer::SurfaceDamage(const Damage& damage) const
+{
+    const Rect surface { 0, 0, width_, height_ };
+    if (damage.width <= 0 || damage.height <= 0)
+        return surface;
+    if (damage.bufferWidth != width_ || damage.bufferHeight != height_)
+        return surface;
+
+    const int left = std::max(damage.x, 0);
+    const int top = std::max(damage.y, 0);
+    const int right = std::min(damage.x + damage.width, width_);
+    const int bottom = std::min(damage.y + damage.height, height_);
+    if (left >= right || top >= bottom)
+        return surface;
+    return { left, height_ - bottom, right - left, bottom - top };
+}
+
+WPEViewOHOSGLES3Renderer::Rect WPEViewOHOSGLES3Renderer::RepaintRegion(const Rect& frameDamage) const
+{
+    const Rect surface { 0, 0, width_, height_ };
+    if (!hasBufferAge_)
+        return surface;
+
+    // 0 is a new buffer, N one last drawn N frames ago.
+    EGLint age = 0;
+    if (!eglQuerySurface(eglDisplay_, eglSurface_, EGL_BUFFER_AGE_EXT, &age) || age <= 0)
+        return surface;
+    if (static_cast<size_t>(age - 1) > damageHistory_.size())
+        return surface;
+
+    int left = frameDamage.x;
+    int bottom = frameDamage.y;
+    int right = frameDamage.x + frameDamage.width;
+    int top = frameDamage.y + frameDamage.height;
+    for (EGLint i = 0; i < age - 1; ++i) {
+        const Rect& rect = damageHistory_[i];
+        left = std::min(left, rect.x);
+        bottom = std::min(bottom, rect.y);
+        right = std::max(right, rect.x + rect.width);
+        top = std::max(top, rect.y + rect.height);
     }
+    return { left, bottom, right - left, top - bottom };
 }
 
-int WPEViewOHOSGLES3Renderer::Render(EGLImage image, int acquireFenceFd)
+int WPEViewOHOSGLES3Renderer::Render(EGLImage image, int acquireFenceFd, const Damage& damage)
 {
-    if (image == EGL_NO_IMAGE) {
-        LOGE("Failed to bind OH_NativeBuffer to an EGLImage.");
+    if (image == EGL_NO_IMAGE || eglSurface_ == EGL_NO_SURFACE) {
+        if (image == EGL_NO_IMAGE)
+            LOGE("Failed to bind OH_NativeBuffer to an EGLImage.");
         if (acquireFenceFd >= 0)
             close(acquireFenceFd);
         return -1;
@@ -123,47 +289,96 @@ int WPEViewOHOSGLES3Renderer::Render(EGLImage image, int acquireFenceFd)
     // Make the GPU wait for the WebProcess's rendering fence before we sample the buffer.
     WaitAcquireFence(acquireFenceFd);
 
+    // The buffer age query has to come before eglSetDamageRegionKHR.
+    const Rect frameDamage = SurfaceDamage(damage);
+    const Rect repaint = RepaintRegion(frameDamage);
+    const bool partial = repaint.width != width_ || repaint.height != height_;
+    if (eglSetDamageRegionKHR_) {
+        EGLint rect[] = { repaint.x, repaint.y, repaint.width, repaint.height };
+        eglSetDamageRegionKHR_(eglDisplay_, eglSurface_, rect, 1);
+    }
+
     glViewport(0,0,width_,height_);
+    if (partial) {
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(repaint.x, repaint.y, repaint.width, repaint.height);
+    }
     glClearColor(0.0f, 0.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    GLint attrPos = glGetAttribLocation(programHandle_, "pos");
-    CheckGLError("glGetAttribLocation pos");
-    GLint attrTexture = glGetAttribLocation(programHandle_, "texture");
-    CheckGLError("glGetAttribLocation texture");
-    GLint uniformTexture = glGetUniformLocation(programHandle_, "u_texture");
-    CheckGLError("glGetUniformLocation u_texture");
-
     glUseProgram(programHandle_);
-    CheckGLError("glUseProgram");
+    glBindVertexArray(vertexArray_);
 
+    DeleteReleasedTextures();
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture_);
-    glEGLImageTargetTexture2DOES_(GL_TEXTURE_2D, image);
-    CheckGLError("pGlEGLImageTargetTexture2DOES");
-    glUniform1i(uniformTexture, 0);
-
-    static float positionCoords[] = { -1, 1, 1, 1, -1, -1, 1, -1 };
-    static float textureCoords[] = { 0, 0, 1, 0, 0, 1, 1, 1 };
-
-    glVertexAttribPointer(attrPos, 2, GL_FLOAT, GL_FALSE, 0, positionCoords);
-    glVertexAttribPointer(attrTexture, 2, GL_FLOAT, GL_FALSE, 0, textureCoords);
-
-    glEnableVertexAttribArray(attrPos);
-    glEnableVertexAttribArray(attrTexture);
+    glBindTexture(GL_TEXTURE_2D, TextureForImage(image));
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-    glDisableVertexAttribArray(attrPos);
-    glDisableVertexAttribArray(attrTexture);
+    if (partial)
+        glDisable(GL_SCISSOR_TEST);
+    CheckGLError("Render");
 
     // Fence capturing this sample; the WebProcess waits it before reusing the buffer.
     int releaseFenceFd = CreateReleaseFence();
 
-    eglSwapBuffers(eglDisplay_, eglSurface_);
+    // The compositor only needs to know what changed since the last frame.
+    if (eglSwapBuffersWithDamage_) {
+        EGLint rect[] = { frameDamage.x, frameDamage.y, frameDamage.width, frameDamage.height };
+        eglSwapBuffersWithDamage_(eglDisplay_, eglSurface_, rect, 1);
+    } else {
+        eglSwapBuffers(eglDisplay_, eglSurface_);
+    }
+
+    damageHistory_.insert(damageHistory_.begin(), frameDamage);
+    if (damageHistory_.size() > kMaxBufferAge)
+        damageHistory_.pop_back();
+    s_frames.fetch_add(1, std::memory_order_relaxed);
+    s_pixelsDrawn.fetch_add(static_cast<uint64_t>(repaint.width) * repaint.height, std::memory_order_relaxed);
+    s_surfacePixels.fetch_add(static_cast<uint64_t>(width_) * height_, std::memory_order_relaxed);
     return releaseFenceFd;
 }
 
+void WPEViewOHOSGLES3Renderer::ReleaseImage(EGLImage image)
+{
+    auto it = textures_.find(image);
+    if (it == textures_.end())
+        return;
+    releasedTextures_.push_back(it->second);
+    textures_.erase(it);
+
+    // The texture keeps the buffer's memory alive, so free it now if there
+    // is a surface to make the context current with.
+    if (eglSurface_ != EGL_NO_SURFACE && eglMakeCurrent(eglDisplay_, eglSurface_, eglSurface_, eglContext_))
+        DeleteReleasedTextures();
+}
+
+GLuint WPEViewOHOSGLES3Renderer::TextureForImage(EGLImage image)
+{
+    auto it = textures_.find(image);
+    if (it != textures_.end())
+        return it->second;
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glEGLImageTargetTexture2DOES_(GL_TEXTURE_2D, image);
+    CheckGLError("glEGLImageTargetTexture2DOES");
+    textures_.emplace(image, texture);
+    return texture;
+}
+
+void WPEViewOHOSGLES3Renderer::DeleteReleasedTextures()
+{
+    if (releasedTextures_.empty())
+        return;
+    glDeleteTextures(releasedTextures_.size(), releasedTextures_.data());
+    releasedTextures_.clear();
+}
+
 void WPEViewOHOSGLES3Renderer::WaitAcquireFence(int fenceFd)
 {
     if (fenceFd < 0)
@@ -237,8 +452,22 @@ bool WPEViewOHOSGLES3Renderer::InitializeEGL()
     if (!eglCreateSyncKHR_ || !eglDestroySyncKHR_ || !eglWaitSyncKHR_ || !eglDupNativeFenceFDANDROID_)
         LOGE("Missing EGL fence sync entrypoints; explicit sync disabled");
 
+    // Partial presentation entrypoints. Optional: without them every frame is drawn and
+    // swapped in full.
+    const char* extensions = eglQueryString(eglDisplay_, EGL_EXTENSIONS);
+    hasBufferAge_ = HasExtension(extensions, "EGL_EXT_buffer_age") || HasExtension(extensions, "EGL_KHR_partial_update");
+    if (HasExtension(extensions, "EGL_KHR_partial_update"))
+        eglSetDamageRegionKHR_ = reinterpret_cast<PFNEGLSETDAMAGEREGIONKHRPROC>(eglGetProcAddress("eglSetDamageRegionKHR"));
+    if (HasExtension(extensions, "EGL_KHR_swap_buffers_with_damage")) {
+        eglSwapBuffersWithDamage_ =
+            reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+    } else if (HasExtension(extensions, "EGL_EXT_swap_buffers_with_damage")) {
+        eglSwapBuffersWithDamage_ =
+            reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+    }
+
     static const EGLint configAttributes[] = {
-        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
         EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
         EGL_RED_SIZE, 8,
         EGL_GREEN_SIZE, 8,
@@ -248,8 +477,7 @@ bool WPEViewOHOSGLES3Renderer::InitializeEGL()
     };
 
     EGLint count;
-    EGLConfig config;
-    if (!eglChooseConfig(eglDisplay_, configAttributes, &config, 1, &count)) {
+    if (!eglChooseConfig(eglDisplay_, configAttributes, &eglConfig_, 1, &count)) {
         LOGE("Failed to choose EGL config");
         return false;
     }
@@ -260,41 +488,41 @@ bool WPEViewOHOSGLES3Renderer::InitializeEGL()
     }
 
     static const EGLint contextAttributes[] = {
-        EGL_CONTEXT_CLIENT_VERSION, 2,
+        EGL_CONTEXT_CLIENT_VERSION, 3,
         EGL_NONE,
     };
 
-    eglContext_ = eglCreateContext(eglDisplay_, config, EGL_NO_CONTEXT, contextAttributes);
+    eglContext_ = eglCreateContext(eglDisplay_, eglConfig_, EGL_NO_CONTEXT, contextAttributes);
     if (eglContext_ == EGL_NO_CONTEXT) {
         LOGE("Failed to create EGL context");
         return false;
     }
 
-    EGLNativeWindowType eglWindow = reinterpret_cast<EGLNativeWindowType>(nativeWindow_);
-    eglSurface_ = eglCreateWindowSurface(eglDisplay_, config, eglWindow, nullptr);
-    if (eglSurface_ == EGL_NO_SURFACE) {
-        LOGE("Failed to create EGL window surface");
-        return false;
-    }
-
-    if (!eglMakeCurrent(eglDisplay_, eglSurface_, eglSurface_, eglContext_)) {
-        LOGE("Failed to make EGL context current");
+    if (!SetSurface(nativeWindow_, width_, height_))
         return false;
-    }
 
     programHandle_ = CreateProgram(s_vertexShaderSource, s_fragmentShaderSource);
     if (!programHandle_) {
         LOGE("Could not create CreateProgram");
         return false;
     }
-
-    glGenTextures(1, &texture_);
-    glBindTexture(GL_TEXTURE_2D, texture_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // The sampler always reads unit 0; program state keeps it.
+    glUseProgram(programHandle_);
+    glUniform1i(glGetUniformLocation(programHandle_, "u_texture"), 0);
+
+    glGenVertexArrays(1, &vertexArray_);
+    glGenBuffers(1, &vertexBuffer_);
+    glBindVertexArray(vertexArray_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(s_quadVertices), s_quadVertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(kPositionLocation, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
+    glVertexAttribPointer(kTexCoordLocation, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat),
+        reinterpret_cast<const void*>(2 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(kPositionLocation);
+    glEnableVertexAttribArray(kTexCoordLocation);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    CheckGLError("InitializeEGL");
 
     return true;
 }
@@ -338,7 +566,7 @@ GLuint WPEViewOHOSGLES3Renderer::CreateProgram(const char *vertexShader, const c
         glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
         if (infoLen > 1) {
             std::string infoLog(infoLen, '\0');
-            glGetProgramInfoLog(program, infoLen, nullptr, (GLchar *)&infoLog);
+            glGetProgramInfoLog(program, infoLen, nullptr, &infoLog[0]);
             LOGE("Error linking program:%{public}s\n", infoLog.c_str());
         }
         glDeleteShader(vertex);
@@ -374,7 +602,7 @@ GLuint WPEViewOHOSGLES3Renderer::LoadShader(GLenum type, const char *shaderSrc)
 
         if (infoLen > 1) {
             std::string infoLog(infoLen, '\0');
-            glGetShaderInfoLog(shader, infoLen, nullptr, (GLchar *)&infoLog);
+            glGetShaderInfoLog(shader, infoLen, nullptr, &infoLog[0]);
             LOGE("Error compiling shader:%{public}s\n", infoLog.c_str());
         }
 
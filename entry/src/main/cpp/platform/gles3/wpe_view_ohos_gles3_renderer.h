@@ -22,8 +22,10 @@
 #include <EGL/eglext.h>
 #include <GLES3/gl3.h>
 #include <GLES2/gl2ext.h>
+#include <cstdint>
 #include <native_window/external_window.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 
@@ -37,14 +39,48 @@ public:
     bool Initialize(OHNativeWindow* nativeWindow, int width, int height) override;
     void Cleanup() override;
 
-    int Render(EGLImage image, int acquireFenceFd) override;
+    bool SetSurface(OHNativeWindow* nativeWindow, int width, int height) override;
+    void ReleaseSurface() override;
+    void Resize(int width, int height) override;
+
+    int Render(EGLImage image, int acquireFenceFd, const Damage& damage) override;
+    void ReleaseImage(EGLImage image) override;
+
+    // Frames rendered, pixels drawn and surface pixels, over all renderers.
+    static void GetPixelStats(uint64_t* frames, uint64_t* pixelsDrawn, uint64_t* surfacePixels);
+
+protected:
+    // The EGL window surface alone, on the native window SetSurface() was
+    // given; the GL state and the window stay. While it is destroyed EGL
+    // holds none of the window's buffers and Render() draws nothing. A
+    // recreated surface starts with its back buffers redrawn in full.
+    bool CreateWindowSurface();
+    void DestroyWindowSurface();
+    bool HasWindowSurface() const { return eglSurface_ != EGL_NO_SURFACE; }
 
 private:
+    // In surface pixels, bottom-left origin, as EGL and glScissor take them.
+    struct Rect {
+        EGLint x = 0;
+        EGLint y = 0;
+        EGLint width = 0;
+        EGLint height = 0;
+    };
 
     bool InitializeEGL();
+    // damage on the surface; the whole surface when it is empty or the
+    // buffer is being stretched to a new size.
+    Rect SurfaceDamage(const Damage& damage) const;
+    // The region of the back buffer that is out of date: the frame's damage
+    // plus that of the frames since the buffer was last drawn.
+    Rect RepaintRegion(const Rect& frameDamage) const;
     GLuint CreateProgram(const char *vertexShader, const char *fragShader);
     GLuint LoadShader(GLenum type, const char *shaderSrc);
 
+    // The texture bound to image, created on first use; current context only.
+    GLuint TextureForImage(EGLImage image);
+    void DeleteReleasedTextures();
+
     void WaitAcquireFence(int fenceFd);
     int CreateReleaseFence();
 
@@ -60,10 +96,27 @@ private:
     PFNEGLWAITSYNCKHRPROC eglWaitSyncKHR_ = nullptr;
     PFNEGLDUPNATIVEFENCEFDANDROIDPROC eglDupNativeFenceFDANDROID_ = nullptr;
 
+    // Partial presentation (EGL_EXT_buffer_age, EGL_KHR_partial_update,
+    // EGL_KHR/EXT_swap_buffers_with_damage); without buffer age every frame
+    // is redrawn in full.
+    bool hasBufferAge_ = false;
+    PFNEGLSETDAMAGEREGIONKHRPROC eglSetDamageRegionKHR_ = nullptr;
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC eglSwapBuffersWithDamage_ = nullptr;
+    // Damage of the last frames, newest first.
+    std::vector<Rect> damageHistory_;
+
     EGLDisplay eglDisplay_ = EGL_NO_DISPLAY;
+    EGLConfig eglConfig_ = nullptr;
     EGLContext eglContext_ = EGL_NO_CONTEXT;
     EGLSurface eglSurface_ = EGL_NO_SURFACE;
-    GLuint programHandle_;
-    GLuint texture_;
+    GLuint programHandle_ = 0;
+
+    // One texture per EGLImage: WebKit cycles a few buffers, so after the
+    // first frames a present only binds a texture. Textures of released
+    // images wait in releasedTextures_ until the context can be made current.
+    std::unordered_map<EGLImage, GLuint> textures_;
+    std::vector<GLuint> releasedTextures_;
+    GLuint vertexArray_ = 0;
+    GLuint vertexBuffer_ = 0;
 };
 
@@ -68,3 +68,15 @@ WPEToplevel *wpe_toplevel_ohos_new (WPEDisplay *display)
 {
     return WPE_TOPLEVEL(g_object_new(WPE_TYPE_TOPLEVEL_OHOS, "display", display, nullptr));
 }
+
+void wpe_toplevel_ohos_set_active(WPEToplevel* toplevel, gboolean active)
+{
+    g_return_if_fail(WPE_IS_TOPLEVEL_OHOS(toplevel));
+
+    const WPEToplevelState state = wpe_toplevel_get_state(toplevel);
+    const WPEToplevelState newState = active
+        ? static_cast<WPEToplevelState>(state | WPE_TOPLEVEL_STATE_ACTIVE)
+        : static_cast<WPEToplevelState>(state & ~WPE_TOPLEVEL_STATE_ACTIVE);
+    if (newState != state)
+        wpe_toplevel_state_changed(toplevel, newState);
+}
@@ -27,5 +27,8 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (WPEToplevelOHOS, wpe_toplevel_ohos, WPE, TOPLEVEL_OHOS, WPEToplevel)
 
 WPEToplevel* wpe_toplevel_ohos_new(WPEDisplay *display);
+// Follows the ability's foreground state; WebKit treats an inactive
+// toplevel's views as in an unfocused window.
+void wpe_toplevel_ohos_set_active(WPEToplevel* toplevel, gboolean active);
 
 G_END_DECLS
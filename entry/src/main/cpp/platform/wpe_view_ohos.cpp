@@ -20,8 +20,19 @@
 
 #include "log.h"
 
+#include "platform/wpe_view_ohos_frame_scheduler.h"
 #include "platform/wpe_view_ohos_renderer.h"
-
+#include "platform/wpe_view_ohos_vsync.h"
+#include "runtime/latency_stats.h"
+#include "runtime/pump_stats.h"
+#include "runtime/startup_trace.h"
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include <time.h>
+#include <unistd.h>
+#include <window_manager/oh_display_manager.h>
 #include <wpe-platform/wpe/WPEBufferOHOS.h>
 
 struct _WPEViewOHOS {
@@ -31,12 +42,263 @@ struct _WPEViewOHOS {
     WPEBuffer* committedBuffer;
     GSource* frameSource;
 
+    // committedBuffer went to the window as is (PresentBuffer()). Once
+    // replaced it moves to scanoutBuffers, and WebKit gets it back when the
+    // renderer reports the window has released it.
+    gboolean committedDirect;
+    GPtrArray* scanoutBuffers;
+
     std::shared_ptr<WPEViewOHOSRenderer> renderer;
+
+    // Presents on the display's vsync, or without one when frameSource,
+    // its timer, fires. lastFrameTime is the frame time of the last present.
+    WPEViewOHOSFrameScheduler* scheduler;
     gint64 lastFrameTime;
+
+    // Bounds of the damage WebKit reported since the last presented buffer,
+    // in view coordinates; pendingDamageFull when it covers the whole view.
+    WPERectangle pendingDamage;
+    gboolean pendingDamageFull;
+
+    // WPEBuffer -> EGLImage of the buffers presented so far, each watched by
+    // a weak ref. imageRenderer keeps a texture per image, which it drops
+    // when the buffer is destroyed; it outlives a surface loss, when
+    // renderer is unset, so a kept renderer keeps its textures.
+    GHashTable* importedBuffers;
+    std::shared_ptr<WPEViewOHOSRenderer> imageRenderer;
+
+    void (*presentCallback)(gpointer);
+    gpointer presentCallbackData;
 };
 
 G_DEFINE_FINAL_TYPE(WPEViewOHOS, wpe_view_ohos, WPE_TYPE_VIEW)
 
+static LatencyStats s_renderStats;
+static LatencyStats s_frameIntervalStats;
+static std::atomic<guint64> s_importHits { 0 };
+static std::atomic<guint64> s_importMisses { 0 };
+static std::atomic<guint64> s_directPresents { 0 };
+static void (*s_frameClock)(gint64, gint64, gpointer) = nullptr;
+static gpointer s_frameClockData = nullptr;
+
+static gint64 threadCPUTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+}
+
+static void wpeViewOHOSBufferDestroyed(gpointer userData, GObject* buffer)
+{
+    auto* view = WPE_VIEW_OHOS(userData);
+    auto eglImage = static_cast<EGLImage>(g_hash_table_lookup(view->importedBuffers, buffer));
+    g_hash_table_remove(view->importedBuffers, buffer);
+    if (view->imageRenderer)
+        view->imageRenderer->ReleaseImage(eglImage);
+}
+
+static void wpeViewOHOSForgetImportedBuffers(WPEViewOHOS* view)
+{
+    GHashTableIter iter;
+    gpointer buffer, eglImage;
+    g_hash_table_iter_init(&iter, view->importedBuffers);
+    while (g_hash_table_iter_next(&iter, &buffer, &eglImage)) {
+        g_object_weak_unref(G_OBJECT(buffer), wpeViewOHOSBufferDestroyed, view);
+        if (view->imageRenderer)
+            view->imageRenderer->ReleaseImage(eglImage);
+        g_hash_table_iter_remove(&iter);
+    }
+}
+
+// WebKit cycles a few buffers, so after the first frames this is a lookup.
+static EGLImage wpeViewOHOSImportBuffer(WPEViewOHOS* view, WPEBuffer* buffer, GError** error)
+{
+    if (auto eglImage = g_hash_table_lookup(view->importedBuffers, buffer)) {
+        s_importHits.fetch_add(1, std::memory_order_relaxed);
+        return static_cast<EGLImage>(eglImage);
+    }
+
+    auto eglImage = wpe_buffer_import_to_egl_image(buffer, error);
+    if (!eglImage)
+        return nullptr;
+    s_importMisses.fetch_add(1, std::memory_order_relaxed);
+    g_hash_table_insert(view->importedBuffers, buffer, eglImage);
+    g_object_weak_ref(G_OBJECT(buffer), wpeViewOHOSBufferDestroyed, view);
+    return eglImage;
+}
+
+static void wpeViewOHOSAddDamage(WPEViewOHOS* view, const WPERectangle* damageRects, guint nDamageRects)
+{
+    // No rects: the whole buffer is new.
+    if (!nDamageRects) {
+        view->pendingDamageFull = TRUE;
+        return;
+    }
+
+    auto& bounds = view->pendingDamage;
+    for (guint i = 0; i < nDamageRects; ++i) {
+        const auto& rect = damageRects[i];
+        if (rect.width <= 0 || rect.height <= 0)
+            continue;
+        if (bounds.width <= 0 || bounds.height <= 0) {
+            bounds = rect;
+            continue;
+        }
+        int left = MIN(bounds.x, rect.x);
+        int top = MIN(bounds.y, rect.y);
+        int right = MAX(bounds.x + bounds.width, rect.x + rect.width);
+        int bottom = MAX(bounds.y + bounds.height, rect.y + rect.height);
+        bounds = { left, top, right - left, bottom - top };
+    }
+}
+
+// The pending damage in buffer pixels; clears it.
+static WPEViewOHOSRenderer::Damage wpeViewOHOSTakeDamage(WPEViewOHOS* view, WPEBuffer* buffer)
+{
+    WPEViewOHOSRenderer::Damage damage;
+    damage.bufferWidth = wpe_buffer_get_width(buffer);
+    damage.bufferHeight = wpe_buffer_get_height(buffer);
+    if (!view->pendingDamageFull) {
+        // Round outwards, so a fractional scale cannot leave a seam.
+        const gdouble scale = wpe_view_get_scale(WPE_VIEW(view));
+        const auto& bounds = view->pendingDamage;
+        damage.x = static_cast<int>(floor(bounds.x * scale));
+        damage.y = static_cast<int>(floor(bounds.y * scale));
+        damage.width = static_cast<int>(ceil((bounds.x + bounds.width) * scale)) - damage.x;
+        damage.height = static_cast<int>(ceil((bounds.y + bounds.height) * scale)) - damage.y;
+    }
+    view->pendingDamage = { 0, 0, 0, 0 };
+    view->pendingDamageFull = FALSE;
+    return damage;
+}
+
+// Gives WebKit back the directly presented buffers the renderer reports the
+// window has released, each with the window's release fence.
+static void wpeViewOHOSReleaseScanoutBuffers(WPEViewOHOS* viewOHOS)
+{
+    std::vector<WPEViewOHOSRenderer::ReleasedBuffer> released;
+    viewOHOS->renderer->TakeReleasedBuffers(released);
+    for (const auto& entry : released) {
+        // The committed buffer, drawn again by the GL path, has left the
+        // window; WebKit gets it back like a GL-path buffer once replaced, by
+        // which time the compositor's fence has long signaled.
+        if (viewOHOS->committedDirect
+            && wpe_buffer_ohos_get_native_buffer(WPE_BUFFER_OHOS(viewOHOS->committedBuffer)) == entry.nativeBuffer) {
+            viewOHOS->committedDirect = FALSE;
+            if (entry.releaseFenceFd >= 0)
+                close(entry.releaseFenceFd);
+            continue;
+        }
+
+        guint index = 0;
+        while (index < viewOHOS->scanoutBuffers->len
+            && wpe_buffer_ohos_get_native_buffer(WPE_BUFFER_OHOS(g_ptr_array_index(viewOHOS->scanoutBuffers, index))) != entry.nativeBuffer)
+            ++index;
+        if (index == viewOHOS->scanoutBuffers->len) {
+            if (entry.releaseFenceFd >= 0)
+                close(entry.releaseFenceFd);
+            continue;
+        }
+
+        auto* buffer = static_cast<WPEBuffer*>(g_ptr_array_index(viewOHOS->scanoutBuffers, index));
+        wpe_buffer_ohos_set_release_fence(WPE_BUFFER_OHOS(buffer), entry.releaseFenceFd);
+        wpe_view_buffer_released(WPE_VIEW(viewOHOS), buffer);
+        g_ptr_array_remove_index_fast(viewOHOS->scanoutBuffers, index);
+    }
+}
+
+// Called by the scheduler on a vsync (or at the timer's deadline): presents
+// the pending buffer, or the committed one again, and tells WebKit the
+// frame is done.
+static void wpeViewOHOSPresent(WPEViewOHOS* viewOHOS, gint64 frameTime)
+{
+    auto* view = WPE_VIEW(viewOHOS);
+
+    // Presenting the committed buffer again (after a resize or while
+    // hidden) draws all of it.
+    WPEViewOHOSRenderer::Damage damage;
+    gboolean notifyBufferRendered = FALSE;
+    if (viewOHOS->pendingBuffer) {
+        damage = wpeViewOHOSTakeDamage(viewOHOS, viewOHOS->pendingBuffer);
+        notifyBufferRendered = TRUE;
+        if (viewOHOS->committedBuffer && viewOHOS->committedDirect) {
+            g_ptr_array_add(viewOHOS->scanoutBuffers, g_steal_pointer(&viewOHOS->committedBuffer));
+        } else if (viewOHOS->committedBuffer) {
+            wpe_view_buffer_released(view, viewOHOS->committedBuffer);
+            g_object_unref(viewOHOS->committedBuffer);
+        }
+        viewOHOS->committedBuffer = g_steal_pointer(&viewOHOS->pendingBuffer);
+        viewOHOS->committedDirect = FALSE;
+    }
+
+    if (!viewOHOS->committedBuffer)
+        return;
+
+    // Intervals of an animation's frames; a longer gap is the page idling.
+    if (viewOHOS->lastFrameTime && frameTime - viewOHOS->lastFrameTime <= 2 * viewOHOS->scheduler->FrameIntervalUs())
+        s_frameIntervalStats.Record(frameTime - viewOHOS->lastFrameTime);
+    viewOHOS->lastFrameTime = frameTime;
+    if (s_frameClock)
+        s_frameClock(frameTime, viewOHOS->scheduler->RefreshPeriodUs(), s_frameClockData);
+
+    if (viewOHOS->renderer) {
+        auto* ohosBuffer = WPE_BUFFER_OHOS(viewOHOS->committedBuffer);
+        int acquireFenceFd = wpe_buffer_ohos_take_rendering_fence(ohosBuffer);
+        auto renderStart = threadCPUTime();
+        auto* nativeBuffer = wpe_buffer_ohos_get_native_buffer(ohosBuffer);
+        if (viewOHOS->renderer->PresentBuffer(nativeBuffer, acquireFenceFd, damage)) {
+            viewOHOS->committedDirect = TRUE;
+            s_directPresents.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            GError* bufferError = nullptr;
+            auto eglImage = wpeViewOHOSImportBuffer(viewOHOS, viewOHOS->committedBuffer, &bufferError);
+            if (!eglImage) {
+                LOGD("WPEViewOHOS::render_buffer - failed to import buffer to EGL image: %s",
+                    bufferError ? bufferError->message : "unknown error");
+                if (bufferError)
+                    g_error_free(bufferError);
+                if (acquireFenceFd >= 0)
+                    close(acquireFenceFd);
+                return;
+            }
+            int releaseFenceFd = viewOHOS->renderer->Render(eglImage, acquireFenceFd, damage);
+            wpe_buffer_ohos_set_release_fence(ohosBuffer, releaseFenceFd);
+        }
+        wpeViewOHOSReleaseScanoutBuffers(viewOHOS);
+        s_renderStats.Record(threadCPUTime() - renderStart);
+        // Either path: a direct present never reaches Render().
+        STARTUP_TRACE_INSTANT_ONCE("firstFrame");
+        if (viewOHOS->presentCallback)
+            viewOHOS->presentCallback(viewOHOS->presentCallbackData);
+    }
+
+    if (notifyBufferRendered)
+        wpe_view_buffer_rendered(view, viewOHOS->committedBuffer);
+}
+
+// Without vsync, frameSource fires at the scheduler's deadline.
+static void wpeViewOHOSArmTimer(WPEViewOHOS* view)
+{
+    if (view->frameSource && view->scheduler)
+        g_source_set_ready_time(view->frameSource, view->scheduler->TimerDeadline(g_get_monotonic_time()));
+}
+
+static void wpeViewOHOSRequestFrame(WPEViewOHOS* view)
+{
+    if (!view->scheduler)
+        return;
+    view->scheduler->RequestFrame();
+    wpeViewOHOSArmTimer(view);
+}
+
+static void wpeViewOHOSCancelFrame(WPEViewOHOS* view)
+{
+    if (view->scheduler)
+        view->scheduler->Cancel();
+    if (view->frameSource)
+        g_source_set_ready_time(view->frameSource, -1);
+}
+
 static GSourceFuncs frameSourceFuncs = {
     nullptr, // prepare
     nullptr, // check
@@ -62,52 +324,43 @@ static void wpeViewOHOSConstructed(GObject* object)
     g_source_set_priority(view->frameSource, G_PRIORITY_DEFAULT);
     g_source_set_name(view->frameSource, "WPE OHOS frame timer");
     g_source_set_callback(view->frameSource, [](gpointer userData) -> gboolean {
-        auto* view = WPE_VIEW(userData);
-        auto* viewOHOS = WPE_VIEW_OHOS(view);
-
-        gboolean notifyBufferRendered = FALSE;
-        if (viewOHOS->pendingBuffer) { 
-            notifyBufferRendered = TRUE;
-            if (viewOHOS->committedBuffer) {
-                wpe_view_buffer_released(view, viewOHOS->committedBuffer);
-                g_object_unref(viewOHOS->committedBuffer);
-            }
-            viewOHOS->committedBuffer = g_steal_pointer(&viewOHOS->pendingBuffer);
-        }
-
-        if (!viewOHOS->committedBuffer)
-            return G_SOURCE_CONTINUE;
-
-        GError* bufferError;
-        auto eglImage = wpe_buffer_import_to_egl_image(viewOHOS->committedBuffer, &bufferError);
-        if (!eglImage) {
-            LOGD("WPEViewOHOS::render_buffer - failed to import buffer to EGL image: %s",
-                bufferError ? bufferError->message : "unknown error");
-            if (bufferError)
-                g_error_free(bufferError);
-            return G_SOURCE_CONTINUE;
-        }
-
-        if (viewOHOS->renderer) {
-            auto* ohosBuffer = WPE_BUFFER_OHOS(viewOHOS->committedBuffer);
-            int acquireFenceFd = wpe_buffer_ohos_take_rendering_fence(ohosBuffer);
-            int releaseFenceFd = viewOHOS->renderer->Render(eglImage, acquireFenceFd);
-            wpe_buffer_ohos_set_release_fence(ohosBuffer, releaseFenceFd);
-        }
-
-        if (notifyBufferRendered)
-            wpe_view_buffer_rendered(view, viewOHOS->committedBuffer);
-
+        auto* viewOHOS = WPE_VIEW_OHOS(userData);
+        MessagePumpStats::SourceScope statsScope(viewOHOS->frameSource);
+        viewOHOS->scheduler->OnTimer(g_get_monotonic_time());
         if (g_source_is_destroyed(viewOHOS->frameSource))
             return G_SOURCE_REMOVE;
+        wpeViewOHOSArmTimer(viewOHOS);
         return G_SOURCE_CONTINUE;
     }, object, nullptr);
     g_source_attach(view->frameSource, g_main_context_get_thread_default());
     g_source_set_ready_time(view->frameSource, -1);
+
+    // Without the display's vsync, the timer runs at its refresh rate.
+    view->scheduler = new WPEViewOHOSFrameScheduler([view](int64_t frameTimeUs) {
+        wpeViewOHOSPresent(view, frameTimeUs);
+    });
+    uint32_t refreshRate = 0;
+    if (OH_NativeDisplayManager_GetDefaultDisplayRefreshRate(&refreshRate) == DISPLAY_MANAGER_OK)
+        view->scheduler->SetRefreshRate(refreshRate);
+    view->scheduler->SetVSyncSource(
+        WPEViewOHOSVSyncSource::Create(*view->scheduler, g_main_context_get_thread_default()));
+
+    // A hidden view presents nothing: its frame source stops and a buffer
+    // WebKit renders meanwhile waits, unacknowledged, which holds WebKit's
+    // compositor too. Showing the view presents and acknowledges it.
+    g_signal_connect(object, "notify::visible", G_CALLBACK(+[](WPEView* view, GParamSpec*, gpointer) {
+        auto* viewOHOS = WPE_VIEW_OHOS(view);
+        if (!viewOHOS->frameSource)
+            return;
+        if (!wpe_view_get_visible(view))
+            wpeViewOHOSCancelFrame(viewOHOS);
+        else if (viewOHOS->pendingBuffer || viewOHOS->committedBuffer)
+            wpeViewOHOSRequestFrame(viewOHOS);
+    }), nullptr);
 }
 
 static gboolean wpeViewOHOSRenderBuffer(
-    WPEView* view, WPEBuffer* buffer, const WPERectangle* /*damageRects*/, guint nDamageRects, GError** error)
+    WPEView* view, WPEBuffer* buffer, const WPERectangle* damageRects, guint nDamageRects, GError** error)
 {
     g_return_val_if_fail(WPE_IS_VIEW_OHOS(view), FALSE);
 
@@ -119,20 +372,23 @@ static gboolean wpeViewOHOSRenderBuffer(
         return FALSE;
     }
 
+    // Unmapped, the view has no surface (see wpe_view_ohos_release_buffers):
+    // hand a buffer still in flight straight back instead of importing it.
+    if (!wpe_view_get_mapped(view)) {
+        wpe_view_buffer_rendered(view, buffer);
+        wpe_view_buffer_released(view, buffer);
+        return TRUE;
+    }
+
     auto* viewOHOS = WPE_VIEW_OHOS(view);
     g_set_object(&viewOHOS->pendingBuffer, buffer);
+    wpeViewOHOSAddDamage(viewOHOS, damageRects, nDamageRects);
+    if (!wpe_view_get_visible(view))
+        return TRUE;
 
-    // TODO: Maybe could call render directly as we are in the main loop already?
-    // However, schedule next frame to follow the style that other platforms use.
-    auto now = g_get_monotonic_time();
-    if (!viewOHOS->lastFrameTime)
-        viewOHOS->lastFrameTime = now;
-    auto next = viewOHOS->lastFrameTime + (G_USEC_PER_SEC / 60);
-    viewOHOS->lastFrameTime = now;
-    if (next <= now)
-        g_source_set_ready_time(viewOHOS->frameSource, 0);
-    else
-        g_source_set_ready_time(viewOHOS->frameSource, next);
+    // Presented, and acknowledged to WebKit, on the next vsync the frame
+    // rate allows, so WebKit paces its rendering to the display.
+    wpeViewOHOSRequestFrame(viewOHOS);
 
     return TRUE;
 }
@@ -149,12 +405,23 @@ static void wpeViewOHOSDispose(GObject* object)
 
     auto* viewOHOS = WPE_VIEW_OHOS(object);
 
+    // Its vsync source may have a callback pending.
+    if (viewOHOS->scheduler) {
+        delete viewOHOS->scheduler;
+        viewOHOS->scheduler = nullptr;
+    }
     if (viewOHOS->frameSource) {
         g_source_destroy(viewOHOS->frameSource);
         viewOHOS->frameSource = nullptr;
     }
     g_clear_object(&viewOHOS->pendingBuffer);
     g_clear_object(&viewOHOS->committedBuffer);
+    g_clear_pointer(&viewOHOS->scanoutBuffers, g_ptr_array_unref);
+    if (viewOHOS->importedBuffers) {
+        wpeViewOHOSForgetImportedBuffers(viewOHOS);
+        g_clear_pointer(&viewOHOS->importedBuffers, g_hash_table_unref);
+    }
+    viewOHOS->imageRenderer.reset();
     viewOHOS->renderer.reset();
 
     G_OBJECT_CLASS(wpe_view_ohos_parent_class)->dispose(object);
@@ -178,8 +445,17 @@ static void wpe_view_ohos_init(WPEViewOHOS* view)
     view->pendingBuffer = nullptr;
     view->committedBuffer = nullptr;
     view->frameSource = nullptr;
+    view->committedDirect = FALSE;
+    view->scanoutBuffers = g_ptr_array_new_with_free_func(g_object_unref);
     view->renderer = nullptr;
+    view->scheduler = nullptr;
     view->lastFrameTime = 0;
+    view->pendingDamage = { 0, 0, 0, 0 };
+    view->pendingDamageFull = FALSE;
+    view->importedBuffers = g_hash_table_new(nullptr, nullptr);
+    view->imageRenderer = nullptr;
+    view->presentCallback = nullptr;
+    view->presentCallbackData = nullptr;
 }
 
 WPEView* wpe_view_ohos_new(WPEDisplay* display)
@@ -187,6 +463,67 @@ WPEView* wpe_view_ohos_new(WPEDisplay* display)
     return WPE_VIEW(g_object_new(WPE_TYPE_VIEW_OHOS, "display", display, nullptr));
 }
 
+void wpe_view_ohos_set_frame_clock(void (*callback)(gint64, gint64, gpointer), gpointer userData)
+{
+    s_frameClock = callback;
+    s_frameClockData = userData;
+}
+
+void wpe_view_ohos_set_present_callback(WPEViewOHOS* view, void (*callback)(gpointer), gpointer userData)
+{
+    view->presentCallback = callback;
+    view->presentCallbackData = userData;
+}
+
+const LatencyStats& wpe_view_ohos_get_render_stats(void)
+{
+    return s_renderStats;
+}
+
+const LatencyStats& wpe_view_ohos_get_frame_interval_stats(void)
+{
+    return s_frameIntervalStats;
+}
+
+void wpe_view_ohos_get_import_stats(guint64* hits, guint64* misses)
+{
+    *hits = s_importHits.load(std::memory_order_relaxed);
+    *misses = s_importMisses.load(std::memory_order_relaxed);
+}
+
+guint64 wpe_view_ohos_get_direct_presents(void)
+{
+    return s_directPresents.load(std::memory_order_relaxed);
+}
+
+void wpe_view_ohos_release_buffers(WPEViewOHOS* view)
+{
+    g_return_if_fail(WPE_IS_VIEW_OHOS(view));
+
+    LOGD("WPEViewOHOS::release_buffers(%p)", view);
+    auto* wpeView = WPE_VIEW(view);
+    // The first buffer after the view is mapped again goes out on the
+    // next vsync.
+    wpeViewOHOSCancelFrame(view);
+    if (view->pendingBuffer) {
+        wpe_view_buffer_rendered(wpeView, view->pendingBuffer);
+        wpe_view_buffer_released(wpeView, view->pendingBuffer);
+        g_clear_object(&view->pendingBuffer);
+    }
+    // The next buffer's damage is relative to one that was never presented.
+    view->pendingDamageFull = TRUE;
+    if (view->committedBuffer) {
+        wpe_view_buffer_released(wpeView, view->committedBuffer);
+        g_clear_object(&view->committedBuffer);
+    }
+    // The renderer detached them with its surface.
+    for (guint i = 0; i < view->scanoutBuffers->len; ++i)
+        wpe_view_buffer_released(wpeView, static_cast<WPEBuffer*>(g_ptr_array_index(view->scanoutBuffers, i)));
+    g_ptr_array_set_size(view->scanoutBuffers, 0);
+    view->committedDirect = FALSE;
+    view->lastFrameTime = 0;
+}
+
 void wpe_view_ohos_resize( WPEViewOHOS* view, int width, int height)
 {
     g_return_if_fail(WPE_IS_VIEW_OHOS(view));
@@ -195,12 +532,38 @@ void wpe_view_ohos_resize( WPEViewOHOS* view, int width, int height)
     wpe_view_resized(WPE_VIEW(view), width, height);
 }
 
+void wpe_view_ohos_redraw(WPEViewOHOS* view)
+{
+    g_return_if_fail(WPE_IS_VIEW_OHOS(view));
+
+    if (!view->frameSource || !view->committedBuffer)
+        return;
+    if (!wpe_view_get_mapped(WPE_VIEW(view)) || !wpe_view_get_visible(WPE_VIEW(view)))
+        return;
+    wpeViewOHOSRequestFrame(view);
+}
+
+void wpe_view_ohos_set_frame_rate(WPEViewOHOS* view, int fps)
+{
+    g_return_if_fail(WPE_IS_VIEW_OHOS(view));
+
+    LOGD("WPEViewOHOS::set_frame_rate(%p, %d)", view, fps);
+    if (view->scheduler)
+        view->scheduler->SetFrameRate(fps);
+}
+
 void wpe_view_ohos_set_renderer(WPEViewOHOS* view, std::shared_ptr<WPEViewOHOSRenderer> renderer)
 {
     g_return_if_fail(WPE_IS_VIEW_OHOS(view));
 
     LOGD("WPEViewOHOS::set_renderer(%p, %p)", view, renderer.get());
 
+    // Images stay cached across an unset renderer; another renderer has
+    // its own GL state, so the old one drops its textures.
+    if (renderer && renderer != view->imageRenderer) {
+        wpeViewOHOSForgetImportedBuffers(view);
+        view->imageRenderer = renderer;
+    }
     view->renderer = renderer;
 }
 
@@ -23,6 +23,7 @@
 #include <memory>
 #include <wpe-platform/wpe/wpe-platform.h>
 
+class LatencyStats;
 class WPEViewOHOSRenderer;
 
 G_BEGIN_DECLS
@@ -33,8 +34,33 @@ G_DECLARE_FINAL_TYPE(WPEViewOHOS, wpe_view_ohos, WPE, VIEW_OHOS, WPEView)
 
 WPEView* wpe_view_ohos_new(WPEDisplay* display);
 void wpe_view_ohos_resize(WPEViewOHOS* view, int width, int height);
+// Presents the committed buffer again, e.g. stretched to a new renderer
+// viewport while WebKit renders the new size; nothing while hidden.
+void wpe_view_ohos_redraw(WPEViewOHOS* view);
+// Presents at most fps frames per second, on every Nth vsync; 0 presents
+// on every vsync.
+void wpe_view_ohos_set_frame_rate(WPEViewOHOS* view, int fps);
 void wpe_view_ohos_set_renderer(WPEViewOHOS* view, std::shared_ptr<WPEViewOHOSRenderer> renderer);
 void wpe_view_ohos_dispatch_touch_event(WPEViewOHOS* view, OH_NativeXComponent_TouchEvent* event);
+// Returns the pending and presented buffers to WebKit and stops presenting;
+// for an unmapped view whose surface is gone, after the renderer has
+// released the surface (and detached the buffers it presented directly).
+void wpe_view_ohos_release_buffers(WPEViewOHOS* view);
+// Called on WebKit's thread with the frame time (the vsync, or the timer's
+// deadline) of each present and the display's refresh period, both in
+// monotonic microseconds, for any view; null to unset.
+void wpe_view_ohos_set_frame_clock(void (*callback)(gint64 frameTime, gint64 frameInterval, gpointer), gpointer userData);
+// Called after each buffer handed to the renderer; null to unset.
+void wpe_view_ohos_set_present_callback(WPEViewOHOS* view, void (*callback)(gpointer), gpointer userData);
+// Thread CPU time of each renderer Render() call, over all views.
+const LatencyStats& wpe_view_ohos_get_render_stats(void);
+// Interval between consecutive presented frames, over all views.
+const LatencyStats& wpe_view_ohos_get_frame_interval_stats(void);
+// Presents that reused a buffer's EGLImage and texture, and those that
+// imported one, over all views.
+void wpe_view_ohos_get_import_stats(guint64* hits, guint64* misses);
+// Presents that handed WebKit's buffer to the window without a copy.
+guint64 wpe_view_ohos_get_direct_presents(void);
 
 G_END_DECLS
 
@@ -0,0 +1,144 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#include "platform/wpe_view_ohos_frame_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+WPEViewOHOSFrameScheduler::WPEViewOHOSFrameScheduler(std::function<void(int64_t)> frameCallback)
+    : frameCallback_(std::move(frameCallback))
+    , refreshPeriodUs_(1000000 / kDefaultRefreshRate)
+{
+}
+
+void WPEViewOHOSFrameScheduler::SetVSyncSource(std::unique_ptr<VSyncSource> source)
+{
+    vsyncSource_ = std::move(source);
+    vsyncRequested_ = false;
+    nextFrameTimeUs_ = 0;
+    if (frameRequested_)
+        RequestFrame();
+}
+
+void WPEViewOHOSFrameScheduler::SetRefreshRate(int hz)
+{
+    if (hz > 0)
+        refreshPeriodUs_ = 1000000 / hz;
+}
+
+void WPEViewOHOSFrameScheduler::SetFrameRate(int fps)
+{
+    frameRate_ = std::max(fps, 0);
+}
+
+int64_t WPEViewOHOSFrameScheduler::RefreshPeriodUs() const
+{
+    if (vsyncSource_) {
+        if (int64_t periodUs = vsyncSource_->PeriodUs(); periodUs > 0)
+            return periodUs;
+    }
+    return refreshPeriodUs_;
+}
+
+int64_t WPEViewOHOSFrameScheduler::FrameIntervalUs() const
+{
+    const int64_t periodUs = RefreshPeriodUs();
+    if (frameRate_ <= 0)
+        return periodUs;
+
+    // A whole number of refreshes, so frames stay evenly paced: the pinned
+    // rate is a cap, and 60 fps on a 90 Hz panel runs at 45. The slack
+    // absorbs a measured period a little off the nominal one.
+    const double refreshes = 1000000.0 / frameRate_ / periodUs;
+    return std::max<int64_t>(1, static_cast<int64_t>(std::ceil(refreshes - 0.05))) * periodUs;
+}
+
+void WPEViewOHOSFrameScheduler::RequestFrame()
+{
+    frameRequested_ = true;
+    if (!vsyncSource_ || vsyncRequested_)
+        return;
+    if (vsyncSource_->Request()) {
+        vsyncRequested_ = true;
+        return;
+    }
+
+    // The timer takes over, at the rate the source last reported.
+    if (int64_t periodUs = vsyncSource_->PeriodUs(); periodUs > 0)
+        refreshPeriodUs_ = periodUs;
+    vsyncSource_.reset();
+}
+
+void WPEViewOHOSFrameScheduler::Cancel()
+{
+    frameRequested_ = false;
+    nextFrameTimeUs_ = 0;
+}
+
+void WPEViewOHOSFrameScheduler::OnVSync(int64_t timestampUs)
+{
+    vsyncRequested_ = false;
+    if (!frameRequested_ || !vsyncSource_)
+        return;
+
+    // Skip the refreshes between two frames of a pinned rate. Half a
+    // period either way of the due vsync absorbs timestamp jitter. Should
+    // the source fail meanwhile, the frame goes out now rather than wait
+    // for a timer the owner has not armed.
+    if (nextFrameTimeUs_ && timestampUs < nextFrameTimeUs_ - RefreshPeriodUs() / 2) {
+        RequestFrame();
+        if (vsyncSource_)
+            return;
+    }
+    Present(timestampUs);
+}
+
+int64_t WPEViewOHOSFrameScheduler::TimerDeadline(int64_t nowUs) const
+{
+    if (!frameRequested_ || vsyncSource_)
+        return -1;
+    return std::max(nextFrameTimeUs_, nowUs);
+}
+
+void WPEViewOHOSFrameScheduler::OnTimer(int64_t nowUs)
+{
+    if (!frameRequested_ || vsyncSource_ || nowUs < nextFrameTimeUs_)
+        return;
+    Present(nowUs);
+}
+
+void WPEViewOHOSFrameScheduler::Present(int64_t frameTimeUs)
+{
+    const int64_t intervalUs = FrameIntervalUs();
+    if (vsyncSource_) {
+        // Vsyncs are on the display's grid already.
+        nextFrameTimeUs_ = frameTimeUs + intervalUs;
+    } else if (nextFrameTimeUs_ && frameTimeUs - nextFrameTimeUs_ < intervalUs) {
+        // Stay on the timer's grid however late it fired, so the lateness
+        // does not add up over frames.
+        nextFrameTimeUs_ += intervalUs;
+    } else {
+        // The first frame, or the first after a pause, starts a new grid.
+        nextFrameTimeUs_ = frameTimeUs + intervalUs;
+    }
+
+    frameRequested_ = false;
+    frameCallback_(frameTimeUs);
+}
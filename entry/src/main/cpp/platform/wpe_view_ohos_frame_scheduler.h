@@ -0,0 +1,92 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// Decides when a view presents its next frame. It is driven by the
+// display's vsync when there is a VSyncSource, and by a timer at the
+// display's refresh rate otherwise; the owner arms that timer at
+// TimerDeadline(). A pinned frame rate below the refresh rate presents on
+// every Nth vsync instead of every one. Times are monotonic microseconds.
+// Single-threaded: the owner calls everything, and the source ticks, on
+// the view's thread.
+class WPEViewOHOSFrameScheduler final {
+public:
+    class VSyncSource {
+    public:
+        virtual ~VSyncSource() = default;
+
+        // Asks for one OnVSync() at the next vsync; false if the source
+        // has failed.
+        virtual bool Request() = 0;
+        // The refresh period, or 0 while it is not known.
+        virtual int64_t PeriodUs() const = 0;
+    };
+
+    static constexpr int kDefaultRefreshRate = 60;
+
+    // frameCallback presents a frame; frameTimeUs is the vsync (or timer
+    // deadline) it is aligned to. It may call RequestFrame().
+    explicit WPEViewOHOSFrameScheduler(std::function<void(int64_t frameTimeUs)> frameCallback);
+
+    // Null, or a source that fails a Request(), switches to the timer.
+    void SetVSyncSource(std::unique_ptr<VSyncSource> source);
+    bool UsesVSync() const { return vsyncSource_ != nullptr; }
+
+    // The timer's rate, and the period assumed while the source does not
+    // know its own.
+    void SetRefreshRate(int hz);
+    // 0 follows the display.
+    void SetFrameRate(int fps);
+    int FrameRate() const { return frameRate_; }
+
+    int64_t RefreshPeriodUs() const;
+    int64_t FrameIntervalUs() const;
+
+    // A frame is ready; frameCallback runs on the next vsync or timer
+    // deadline it may go out on, never from within this call.
+    void RequestFrame();
+    // Drops a requested frame, e.g. when the view is hidden. The frame
+    // requested after this goes out on the first vsync, or at once.
+    void Cancel();
+
+    void OnVSync(int64_t timestampUs);
+
+    // When the owner's timer should fire: -1 for no timer (nothing
+    // requested, or vsync drives the frames), nowUs for at once.
+    int64_t TimerDeadline(int64_t nowUs) const;
+    void OnTimer(int64_t nowUs);
+
+private:
+    void Present(int64_t frameTimeUs);
+
+    std::function<void(int64_t)> frameCallback_;
+    std::unique_ptr<VSyncSource> vsyncSource_;
+    int64_t refreshPeriodUs_;
+    int frameRate_ = 0;
+    bool frameRequested_ = false;
+    bool vsyncRequested_ = false;
+    // Earliest time the next frame may go out, on the grid of frame
+    // intervals the frames so far fell on; 0 for none.
+    int64_t nextFrameTimeUs_ = 0;
+};
@@ -20,17 +20,70 @@
 
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
+#include <native_buffer/native_buffer.h>
 #include <native_window/external_window.h>
+#include <vector>
 
 class WPEViewOHOSRenderer {
 public:
     ~WPEViewOHOSRenderer() = default;
 
+    // Sets up the GL state and a surface on nativeWindow. Cleanup() tears
+    // all of it down.
     virtual bool Initialize(OHNativeWindow* nativeWindow, int width, int height) = 0;
     virtual void Cleanup() = 0;
 
+    // Surface churn (background, rotation) replaces only the window surface;
+    // the GL state survives. Render() draws nothing while there is none.
+    virtual bool SetSurface(OHNativeWindow* nativeWindow, int width, int height) = 0;
+    virtual void ReleaseSurface() = 0;
+    // The window surface follows its native window's size; this only moves
+    // the viewport the buffer is drawn, and stretched, into.
+    virtual void Resize(int width, int height) = 0;
+
+    // The part of a frame that changed since the previous one, in the
+    // buffer's pixels with a top-left origin, and the buffer's size. An
+    // empty rect means the whole frame.
+    struct Damage {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        int bufferWidth = 0;
+        int bufferHeight = 0;
+    };
+
     // Waits acquireFenceFd (a sync_file fd; -1 for none, ownership taken) on the GPU before
     // sampling, and returns a release-fence fd signaling when sampling completes (-1 if none).
-    virtual int Render(EGLImage eglImage, int acquireFenceFd) = 0;
+    // Only the damaged part of the surface needs to be redrawn.
+    virtual int Render(EGLImage eglImage, int acquireFenceFd, const Damage& damage) = 0;
+
+    // Hands nativeBuffer to the window as is, without a copy, if the renderer
+    // can. The window reads it until a later frame replaces it on screen;
+    // the caller must not reuse it before TakeReleasedBuffers() returns it.
+    // Returns false, with acquireFenceFd still the caller's, to have the
+    // buffer drawn with Render() instead.
+    virtual bool PresentBuffer(OH_NativeBuffer* /*nativeBuffer*/, int /*acquireFenceFd*/, const Damage& /*damage*/)
+    {
+        return false;
+    }
+
+    // A buffer from PresentBuffer() that the window has given back, detached
+    // again, and the fence to wait on before writing to it (-1 if none).
+    struct ReleasedBuffer {
+        OH_NativeBuffer* nativeBuffer;
+        int releaseFenceFd;
+    };
+
+    // Moves the buffers released since the last call to `released`, whose
+    // fences the caller then owns. ReleaseSurface() and Cleanup() detach the
+    // buffers still presented without reporting them: with the surface gone,
+    // the caller may reuse every buffer it presented.
+    virtual void TakeReleasedBuffers(std::vector<ReleasedBuffer>& /*released*/) { }
+
+    // Render() may keep GL state per image (a texture bound to it); this
+    // drops it. Called when the image's buffer goes away, since the handle
+    // can be reused for a different image afterwards.
+    virtual void ReleaseImage(EGLImage eglImage) = 0;
 };
 
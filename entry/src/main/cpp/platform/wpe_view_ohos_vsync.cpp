@@ -0,0 +1,120 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#include "platform/wpe_view_ohos_vsync.h"
+
+#include "log.h"
+
+#include "runtime/pump_stats.h"
+
+#include <atomic>
+#include <native_vsync/native_vsync.h>
+
+struct WPEViewOHOSVSyncSource::Shared {
+    ~Shared() { g_source_unref(source); }
+
+    GSource* source = nullptr;
+    std::atomic<int64_t> timestampUs { 0 };
+};
+
+static GSourceFuncs vsyncSourceFuncs = {
+    nullptr, // prepare
+    nullptr, // check
+    // dispatch
+    [](GSource* source, GSourceFunc callback, gpointer userData) -> gboolean
+    {
+        if (g_source_get_ready_time(source) == -1)
+            return G_SOURCE_CONTINUE;
+        g_source_set_ready_time(source, -1);
+        return callback(userData);
+    },
+    nullptr, // finalize
+    nullptr, // closure_callback
+    nullptr, // closure_marshall
+};
+
+std::unique_ptr<WPEViewOHOSVSyncSource> WPEViewOHOSVSyncSource::Create(
+    WPEViewOHOSFrameScheduler& scheduler, GMainContext* context)
+{
+    static constexpr char kName[] = "WPEViewOHOS";
+    auto* vsync = OH_NativeVSync_Create(kName, sizeof(kName) - 1);
+    if (!vsync) {
+        LOGE("WPEViewOHOSVSyncSource: OH_NativeVSync_Create failed, frames follow a timer");
+        return nullptr;
+    }
+    return std::unique_ptr<WPEViewOHOSVSyncSource>(new WPEViewOHOSVSyncSource(scheduler, vsync, context));
+}
+
+WPEViewOHOSVSyncSource::WPEViewOHOSVSyncSource(
+    WPEViewOHOSFrameScheduler& scheduler, OH_NativeVSync* vsync, GMainContext* context)
+    : scheduler_(scheduler)
+    , vsync_(vsync)
+    , shared_(std::make_shared<Shared>())
+{
+    auto* source = g_source_new(&vsyncSourceFuncs, sizeof(GSource));
+    g_source_set_priority(source, G_PRIORITY_DEFAULT);
+    g_source_set_name(source, "WPE OHOS vsync");
+    g_source_set_callback(source, [](gpointer userData) -> gboolean {
+        auto* self = static_cast<WPEViewOHOSVSyncSource*>(userData);
+        MessagePumpStats::SourceScope statsScope(self->shared_->source);
+
+        long long periodNs = 0;
+        if (OH_NativeVSync_GetPeriod(self->vsync_, &periodNs) == 0 && periodNs > 0)
+            self->periodUs_ = periodNs / 1000;
+        // May replace this source with the timer, deleting self.
+        self->scheduler_.OnVSync(self->shared_->timestampUs.load(std::memory_order_relaxed));
+        return G_SOURCE_CONTINUE;
+    }, this, nullptr);
+    g_source_attach(source, context);
+    g_source_set_ready_time(source, -1);
+    shared_->source = source;
+}
+
+WPEViewOHOSVSyncSource::~WPEViewOHOSVSyncSource()
+{
+    // A callback still pending finds the source destroyed.
+    g_source_destroy(shared_->source);
+    OH_NativeVSync_Destroy(vsync_);
+}
+
+bool WPEViewOHOSVSyncSource::Request()
+{
+    auto* data = new std::shared_ptr<Shared>(shared_);
+    int result = OH_NativeVSync_RequestFrame(vsync_, OnFrame, data);
+    if (result != 0) {
+        LOGE("WPEViewOHOSVSyncSource: OH_NativeVSync_RequestFrame failed (%{public}d), frames follow a timer", result);
+        delete data;
+        return false;
+    }
+    return true;
+}
+
+int64_t WPEViewOHOSVSyncSource::PeriodUs() const
+{
+    return periodUs_;
+}
+
+// On the vsync service's thread; timestamp is CLOCK_MONOTONIC in ns, the
+// clock of g_get_monotonic_time().
+void WPEViewOHOSVSyncSource::OnFrame(long long timestamp, void* data)
+{
+    std::unique_ptr<std::shared_ptr<Shared>> shared(static_cast<std::shared_ptr<Shared>*>(data));
+    (*shared)->timestampUs.store(timestamp / 1000, std::memory_order_relaxed);
+    g_source_set_ready_time((*shared)->source, 0);
+}
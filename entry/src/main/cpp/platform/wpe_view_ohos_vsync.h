@@ -0,0 +1,54 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#pragma once
+
+#include <glib.h>
+#include <memory>
+
+#include "platform/wpe_view_ohos_frame_scheduler.h"
+
+struct OH_NativeVSync;
+
+// The display's vsync, from OH_NativeVSync. Its frame callback runs on the
+// vsync service's thread; it is handed to the scheduler from a GSource on
+// the view's main context.
+class WPEViewOHOSVSyncSource final : public WPEViewOHOSFrameScheduler::VSyncSource {
+public:
+    // Null if there is no vsync service to connect to.
+    static std::unique_ptr<WPEViewOHOSVSyncSource> Create(WPEViewOHOSFrameScheduler& scheduler, GMainContext* context);
+    ~WPEViewOHOSVSyncSource() override;
+
+    bool Request() override;
+    int64_t PeriodUs() const override;
+
+private:
+    struct Shared;
+
+    WPEViewOHOSVSyncSource(WPEViewOHOSFrameScheduler& scheduler, OH_NativeVSync* vsync, GMainContext* context);
+
+    static void OnFrame(long long timestamp, void* data);
+
+    WPEViewOHOSFrameScheduler& scheduler_;
+    OH_NativeVSync* vsync_ = nullptr;
+    // Shared with the callbacks still pending on the vsync thread.
+    std::shared_ptr<Shared> shared_;
+    // Read on each vsync; the panel can switch rates.
+    int64_t periodUs_ = 0;
+};
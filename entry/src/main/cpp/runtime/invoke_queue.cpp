@@ -0,0 +1,190 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "invoke_queue.h"
+
+#include "pump_stats.h"
+
+namespace {
+
+// Ring size; a burst beyond this spills into the locked overflow.
+constexpr size_t kQueueCapacity = 1024;
+
+// Upper bound of tasks run per dispatch of the source, ring and overflow
+// together, so a flood of posts cannot starve WebKit's own sources or the
+// surrounding loop.
+constexpr unsigned kMaxInvocationsPerDispatch = 64;
+
+struct QueueSource {
+    GSource source;
+    InvokeQueue* queue;
+};
+
+} // namespace
+
+GSourceFuncs InvokeQueue::s_sourceFuncs = {
+    &InvokeQueue::onSourcePrepare,
+    &InvokeQueue::onSourceCheck,
+    &InvokeQueue::onSourceDispatch,
+    nullptr, // finalize
+    nullptr, // closure_callback
+    nullptr, // closure_marshal
+};
+
+InvokeQueue::InvokeQueue(GMainContext* context)
+    : m_context(g_main_context_ref(context))
+    , m_queue(kQueueCapacity)
+{
+    m_source = g_source_new(&s_sourceFuncs, sizeof(QueueSource));
+    reinterpret_cast<QueueSource*>(m_source)->queue = this;
+    g_source_set_priority(m_source, G_PRIORITY_DEFAULT);
+    g_source_set_name(m_source, "WebKitView invoke queue");
+    g_source_attach(m_source, m_context);
+}
+
+InvokeQueue::~InvokeQueue()
+{
+    g_source_destroy(m_source);
+    g_source_unref(m_source);
+    m_source = nullptr;
+    discard();
+    g_main_context_unref(m_context);
+}
+
+bool InvokeQueue::post(InvokeTask&& task) noexcept
+{
+    // Once something has spilled, keep spilling until the drain has caught up
+    // so that this thread's later posts cannot overtake its earlier ones.
+    // tryPush only consumes the task when it succeeds.
+    if (m_overflowed.load(std::memory_order_acquire) || !m_queue.tryPush(std::move(task))) {
+        std::lock_guard<std::mutex> lock(m_overflowMutex);
+        m_overflow.push_back(std::move(task));
+        m_overflowed.store(true, std::memory_order_release);
+    }
+
+    // Only the first post after a drain wakes anything; the rest of the batch
+    // is picked up by the same dispatch.
+    if (m_wakeupPending.exchange(true, std::memory_order_acq_rel))
+        return false;
+
+    // Explicit, because GLib does not signal the wakeup fd for work that the
+    // context's owner thread creates itself (same-thread posts). The next
+    // prepare then finds the source ready and dispatches without blocking.
+    g_main_context_wakeup(m_context);
+    return true;
+}
+
+gboolean InvokeQueue::onSourcePrepare(GSource* source, gint* timeout)
+{
+    *timeout = -1;
+    return onSourceCheck(source);
+}
+
+gboolean InvokeQueue::onSourceCheck(GSource* source)
+{
+    InvokeQueue* self = reinterpret_cast<QueueSource*>(source)->queue;
+    return self->m_wakeupPending.load(std::memory_order_acquire) ? TRUE : FALSE;
+}
+
+gboolean InvokeQueue::onSourceDispatch(GSource* source, GSourceFunc, gpointer)
+{
+    MessagePumpStats::SourceScope scope(source);
+    reinterpret_cast<QueueSource*>(source)->queue->drain();
+    return G_SOURCE_CONTINUE;
+}
+
+void InvokeQueue::drain() noexcept
+{
+    // Clear before draining: a post racing with the drain either lands in this
+    // batch or finds the flag clear and issues its own wakeup. The exchange
+    // (not a plain store) orders the clear before the pops below.
+    m_wakeupPending.exchange(false, std::memory_order_acq_rel);
+
+    InvokeTask task;
+    unsigned count = 0;
+    while (count < kMaxInvocationsPerDispatch) {
+        if (!m_queue.tryPop(task)) {
+            // Spilled posts are newer than everything in the ring, so they
+            // only run once the ring is empty.
+            if (!m_overflowed.load(std::memory_order_acquire) || drainOverflow(count))
+                return;
+            break;
+        }
+        task();
+        task.reset();
+        ++count;
+        if (m_stats)
+            ++m_stats->invocations;
+        if (pastDeadline())
+            break;
+    }
+
+    // Batch or time budget used up with work possibly left: stay ready. The
+    // next prepare sees this and polls with a zero timeout, letting the rest
+    // of the context (and the surrounding loop) run in between.
+    m_wakeupPending.store(true, std::memory_order_release);
+}
+
+bool InvokeQueue::drainOverflow(unsigned& count) noexcept
+{
+    // m_overflowed stays set until both the batch taken here and the shared
+    // overflow are empty, so posts made meanwhile (even by the tasks
+    // themselves) queue up behind it.
+    for (;;) {
+        if (m_spilledNext == m_spilled.size()) {
+            m_spilled.clear();
+            m_spilledNext = 0;
+            std::lock_guard<std::mutex> lock(m_overflowMutex);
+            if (m_overflow.empty()) {
+                m_overflowed.store(false, std::memory_order_release);
+                return true;
+            }
+            m_spilled.swap(m_overflow);
+        }
+
+        while (m_spilledNext < m_spilled.size()) {
+            if (count >= kMaxInvocationsPerDispatch)
+                return false;
+            InvokeTask task = std::move(m_spilled[m_spilledNext++]);
+            task();
+            ++count;
+            if (m_stats)
+                ++m_stats->invocations;
+            if (pastDeadline())
+                return false;
+        }
+    }
+}
+
+bool InvokeQueue::pastDeadline() const noexcept
+{
+    return m_deadlineUs != 0 && g_get_monotonic_time() >= m_deadlineUs;
+}
+
+void InvokeQueue::discard() noexcept
+{
+    InvokeTask task;
+    while (m_queue.tryPop(task))
+        task.reset();
+    m_spilled.clear();
+    m_spilledNext = 0;
+
+    std::lock_guard<std::mutex> lock(m_overflowMutex);
+    m_overflow.clear();
+    m_overflowed.store(false, std::memory_order_release);
+}
@@ -0,0 +1,101 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "invoke_task.h"
+#include "mpsc_queue.h"
+
+class MessagePumpStats;
+
+/*
+ * InvokeQueue runs tasks posted from any thread on the thread that iterates a
+ * GMainContext (MessagePump's loop thread, or WebKitThread).
+ *
+ * Posting is lock-free in the common case: one CAS into a bounded MPSC ring,
+ * plus one g_main_context_wakeup for the first post of a batch. One persistent
+ * GSource drains the ring, instead of one idle GSource per post. Tasks always
+ * run from a later dispatch, even when posted on the context's own thread, and
+ * in FIFO order per posting thread.
+ */
+class InvokeQueue final {
+public:
+    explicit InvokeQueue(GMainContext* context);
+
+    InvokeQueue(InvokeQueue&&) = delete;
+    InvokeQueue& operator=(InvokeQueue&&) = delete;
+    InvokeQueue(const InvokeQueue&) = delete;
+    InvokeQueue& operator=(const InvokeQueue&) = delete;
+
+    // Detaches the source; tasks still queued are destroyed without being run.
+    ~InvokeQueue();
+
+    // Thread-safe. Returns true when this post started a new batch, i.e. it
+    // woke the context and the caller may have its own loop to wake as well.
+    bool post(InvokeTask&& task) noexcept;
+
+    // Executed tasks are counted into stats->invocations while set. Consumer
+    // thread only.
+    void setStats(MessagePumpStats* stats) noexcept { m_stats = stats; }
+
+    // Stops a drain once g_get_monotonic_time() reaches `deadlineUs` (0: no
+    // deadline). At least one task runs per drain; the rest stay queued, in
+    // order, and the source stays ready for the next dispatch. Consumer
+    // thread only.
+    void setDeadline(gint64 deadlineUs) noexcept { m_deadlineUs = deadlineUs; }
+
+private:
+    static gboolean onSourcePrepare(GSource* source, gint* timeout);
+    static gboolean onSourceCheck(GSource* source);
+    static gboolean onSourceDispatch(GSource* source, GSourceFunc, gpointer);
+    static GSourceFuncs s_sourceFuncs;
+
+    void drain() noexcept;
+    bool drainOverflow(unsigned& count) noexcept;
+    bool pastDeadline() const noexcept;
+    void discard() noexcept;
+
+    GMainContext* m_context = nullptr;
+    // Ready whenever m_wakeupPending is set.
+    GSource* m_source = nullptr;
+    MPSCQueue<InvokeTask> m_queue;
+    // Set by the first post of a batch (which then wakes the context), cleared
+    // by the drain. Later posts of the same batch see it set and skip the
+    // wakeup.
+    std::atomic<bool> m_wakeupPending { false };
+
+    // Posts that found the ring full. Until it has been drained completely
+    // every post goes here too, and it is only drained once the ring is
+    // empty, so per-thread FIFO order holds across the spill.
+    std::mutex m_overflowMutex;
+    std::vector<InvokeTask> m_overflow;
+    std::atomic<bool> m_overflowed { false };
+    // Consumer side: overflow taken over by a drain, run from m_spilledNext
+    // on across as many drains as the batch and time budgets need.
+    std::vector<InvokeTask> m_spilled;
+    size_t m_spilledNext = 0;
+
+    MessagePumpStats* m_stats = nullptr;
+    gint64 m_deadlineUs = 0;
+};
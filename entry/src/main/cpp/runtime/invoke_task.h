@@ -0,0 +1,153 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+ * InvokeTask is a move-only, type-erased `void()` callable used to post work
+ * to the GLib thread (MessagePump::invoke, WKRuntime::Post).
+ *
+ * Callables up to kInlineCapacity bytes that are nothrow-move-constructible
+ * are stored inline, so posting a lambda with a few captures (an id string,
+ * a window pointer and a size) does not touch the heap. Larger callables fall
+ * back to a single heap allocation.
+ *
+ * A task that is destroyed without having been run simply destroys its
+ * callable; captured resources must therefore clean up after themselves
+ * (RAII captures), there is no separate destroy hook.
+ */
+class InvokeTask final {
+public:
+    static constexpr size_t kInlineCapacity = 64;
+
+    InvokeTask() noexcept = default;
+
+    template<typename Callable,
+        typename = std::enable_if_t<!std::is_same<std::decay_t<Callable>, InvokeTask>::value>>
+    InvokeTask(Callable&& callable)
+    {
+        using Stored = std::decay_t<Callable>;
+        if constexpr (storesInline<Stored>()) {
+            new (m_storage) Stored(std::forward<Callable>(callable));
+            m_ops = &s_inlineOps<Stored>;
+        } else {
+            *reinterpret_cast<Stored**>(m_storage) = new Stored(std::forward<Callable>(callable));
+            m_ops = &s_heapOps<Stored>;
+        }
+    }
+
+    InvokeTask(InvokeTask&& other) noexcept
+    {
+        moveFrom(other);
+    }
+
+    InvokeTask& operator=(InvokeTask&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    InvokeTask(const InvokeTask&) = delete;
+    InvokeTask& operator=(const InvokeTask&) = delete;
+
+    ~InvokeTask()
+    {
+        reset();
+    }
+
+    explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+    void operator()()
+    {
+        if (m_ops != nullptr)
+            m_ops->invoke(m_storage);
+    }
+
+    void reset() noexcept
+    {
+        if (m_ops != nullptr) {
+            m_ops->destroy(m_storage);
+            m_ops = nullptr;
+        }
+    }
+
+    template<typename Callable>
+    static constexpr bool storesInline()
+    {
+        return sizeof(Callable) <= kInlineCapacity
+            && alignof(Callable) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible<Callable>::value;
+    }
+
+    // For posts on a hot path (touch events, surface changes): fails to
+    // compile, instead of silently allocating, once the captures outgrow the
+    // inline storage.
+    template<typename Callable>
+    static InvokeTask inlineOnly(Callable&& callable)
+    {
+        static_assert(storesInline<std::decay_t<Callable>>(),
+            "hot-path task must fit InvokeTask's inline storage");
+        return InvokeTask(std::forward<Callable>(callable));
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        // Move-constructs into `to` and destroys the source.
+        void (*relocate)(void* to, void* from) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename Callable>
+    static constexpr Ops s_inlineOps = {
+        [](void* storage) { (*std::launder(static_cast<Callable*>(storage)))(); },
+        [](void* to, void* from) noexcept {
+            auto* source = std::launder(static_cast<Callable*>(from));
+            new (to) Callable(std::move(*source));
+            source->~Callable();
+        },
+        [](void* storage) noexcept { std::launder(static_cast<Callable*>(storage))->~Callable(); },
+    };
+
+    template<typename Callable>
+    static constexpr Ops s_heapOps = {
+        [](void* storage) { (**static_cast<Callable**>(storage))(); },
+        [](void* to, void* from) noexcept { *static_cast<Callable**>(to) = *static_cast<Callable**>(from); },
+        [](void* storage) noexcept { delete *static_cast<Callable**>(storage); },
+    };
+
+    void moveFrom(InvokeTask& other) noexcept
+    {
+        if (other.m_ops != nullptr) {
+            other.m_ops->relocate(m_storage, other.m_storage);
+            m_ops = other.m_ops;
+            other.m_ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char m_storage[kInlineCapacity];
+    const Ops* m_ops = nullptr;
+};
@@ -0,0 +1,75 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+/*
+ * Count, mean, min and max of a latency, for the JSON stats getters.
+ * Record() and AppendJson() may run on different threads.
+ */
+class LatencyStats final {
+public:
+    void Record(int64_t us) noexcept
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == 0 || us < minUs_)
+            minUs_ = us;
+        if (count_ == 0 || us > maxUs_)
+            maxUs_ = us;
+        sumUs_ += us;
+        ++count_;
+    }
+
+    // Appends "name":{"count":N,"meanMs":N,"minMs":N,"maxMs":N}, or
+    // "name":{"count":0}.
+    void AppendJson(std::string& json, const char* name) const
+    {
+        uint64_t count;
+        int64_t sumUs, minUs, maxUs;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            count = count_;
+            sumUs = sumUs_;
+            minUs = minUs_;
+            maxUs = maxUs_;
+        }
+
+        char buffer[160];
+        if (count == 0) {
+            snprintf(buffer, sizeof(buffer), "\"%s\":{\"count\":0}", name);
+        } else {
+            snprintf(buffer, sizeof(buffer),
+                "\"%s\":{\"count\":%" PRIu64 ",\"meanMs\":%.3f,\"minMs\":%.3f,\"maxMs\":%.3f}", name, count,
+                sumUs / 1000.0 / count, minUs / 1000.0, maxUs / 1000.0);
+        }
+        json += buffer;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    uint64_t count_ = 0;
+    int64_t sumUs_ = 0;
+    int64_t minUs_ = 0;
+    int64_t maxUs_ = 0;
+};
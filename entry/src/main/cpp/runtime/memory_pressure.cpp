@@ -0,0 +1,305 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "memory_pressure.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace MemoryPressure {
+
+namespace {
+
+bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Calls `visit(line, length)` for every line, with or without a final '\n'.
+template<typename Visitor>
+void ForEachLine(const std::string& contents, Visitor&& visit)
+{
+    size_t start = 0;
+    while (start < contents.size()) {
+        size_t end = contents.find('\n', start);
+        if (end == std::string::npos)
+            end = contents.size();
+        visit(contents.data() + start, end - start);
+        start = end + 1;
+    }
+}
+
+// Parses the leading decimal number of [p, end), after blanks. False if
+// there is none or it overflows.
+bool ParseUnsigned(const char* p, const char* end, uint64_t& out)
+{
+    while (p < end && IsSpace(*p))
+        ++p;
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+
+    uint64_t value = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        const uint64_t digit = *p - '0';
+        if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+            return false;
+        value = value * 10 + digit;
+    }
+    out = value;
+    return true;
+}
+
+// The value of "key=<number>" within [p, end).
+bool FindDouble(const char* p, const char* end, const char* key, double& out)
+{
+    const size_t keyLength = strlen(key);
+    for (; p + keyLength < end; ++p) {
+        if (p[keyLength] != '=' || strncmp(p, key, keyLength))
+            continue;
+
+        // The line is not NUL-terminated; copy the short number out.
+        char number[32] = {};
+        const char* value = p + keyLength + 1;
+        size_t length = 0;
+        while (value + length < end && !IsSpace(value[length]) && length < sizeof(number) - 1)
+            ++length;
+        memcpy(number, value, length);
+        char* parsedEnd = nullptr;
+        out = strtod(number, &parsedEnd);
+        return parsedEnd != number;
+    }
+    return false;
+}
+
+bool StartsWith(const char* line, size_t length, const char* prefix)
+{
+    const size_t prefixLength = strlen(prefix);
+    return length >= prefixLength && !strncmp(line, prefix, prefixLength);
+}
+
+} // namespace
+
+const char* LevelName(Level level) noexcept
+{
+    switch (level) {
+    case Level::None:
+        return "none";
+    case Level::NonCritical:
+        return "nonCritical";
+    case Level::Critical:
+        return "critical";
+    }
+    return "none";
+}
+
+bool ParseMeminfo(const std::string& contents, MeminfoSample& out)
+{
+    struct Field {
+        const char* name;
+        uint64_t value;
+        bool found;
+    };
+    enum { Total, Available, Free, ActiveFile, InactiveFile, SReclaimable, Cached, Buffers, FieldCount };
+    Field fields[FieldCount] = {
+        { "MemTotal", 0, false },
+        { "MemAvailable", 0, false },
+        { "MemFree", 0, false },
+        { "Active(file)", 0, false },
+        { "Inactive(file)", 0, false },
+        { "SReclaimable", 0, false },
+        { "Cached", 0, false },
+        { "Buffers", 0, false },
+    };
+
+    ForEachLine(contents, [&](const char* line, size_t length) {
+        const char* end = line + length;
+        const char* colon = static_cast<const char*>(memchr(line, ':', length));
+        if (colon == nullptr)
+            return;
+
+        const char* nameEnd = colon;
+        while (nameEnd > line && IsSpace(nameEnd[-1]))
+            --nameEnd;
+        const size_t nameLength = nameEnd - line;
+
+        for (auto& field : fields) {
+            if (field.found || strlen(field.name) != nameLength || strncmp(field.name, line, nameLength))
+                continue;
+
+            uint64_t value = 0;
+            if (!ParseUnsigned(colon + 1, end, value))
+                return;
+            // Values are in kB; accept a bare number, but not another unit.
+            const char* unit = colon + 1;
+            while (unit < end && (IsSpace(*unit) || (*unit >= '0' && *unit <= '9')))
+                ++unit;
+            const char* unitEnd = end;
+            while (unitEnd > unit && IsSpace(unitEnd[-1]))
+                --unitEnd;
+            if (unit != unitEnd && !(unitEnd - unit == 2 && !strncmp(unit, "kB", 2)))
+                return;
+
+            field.value = value;
+            field.found = true;
+            return;
+        }
+    });
+
+    if (!fields[Total].found || fields[Total].value == 0)
+        return false;
+
+    out.totalKb = fields[Total].value;
+    out.hasMemAvailable = fields[Available].found;
+    if (fields[Available].found) {
+        out.availableKb = fields[Available].value;
+    } else if (fields[Free].found && fields[ActiveFile].found && fields[InactiveFile].found) {
+        // The kernel's own estimate without its low watermark correction.
+        out.availableKb = fields[Free].value + fields[ActiveFile].value + fields[InactiveFile].value
+            + fields[SReclaimable].value;
+    } else if (fields[Free].found) {
+        out.availableKb = fields[Free].value + fields[Cached].value + fields[Buffers].value;
+    } else {
+        return false;
+    }
+
+    if (out.availableKb > out.totalKb)
+        out.availableKb = out.totalKb;
+    return true;
+}
+
+bool ParseCgroupPath(const std::string& contents, std::string& out, bool& isV2)
+{
+    // On a hybrid hierarchy the limits are in the v1 memory controller, so it
+    // wins over the unified entry whatever the line order.
+    bool foundV1 = false;
+    bool foundV2 = false;
+    ForEachLine(contents, [&](const char* line, size_t length) {
+        // "<id>:<controllers>:<path>"
+        const char* end = line + length;
+        const char* first = static_cast<const char*>(memchr(line, ':', length));
+        if (first == nullptr)
+            return;
+        const char* second = static_cast<const char*>(memchr(first + 1, ':', end - first - 1));
+        if (second == nullptr)
+            return;
+
+        const std::string controllers(first + 1, second);
+        const char* pathEnd = end;
+        while (pathEnd > second + 1 && IsSpace(pathEnd[-1]))
+            --pathEnd;
+
+        bool isMemory = false;
+        size_t start = 0;
+        while (start <= controllers.size()) {
+            size_t comma = controllers.find(',', start);
+            if (comma == std::string::npos)
+                comma = controllers.size();
+            if (controllers.compare(start, comma - start, "memory") == 0)
+                isMemory = true;
+            start = comma + 1;
+        }
+
+        if (isMemory) {
+            out.assign(second + 1, pathEnd);
+            isV2 = false;
+            foundV1 = true;
+        } else if (controllers.empty() && !strncmp(line, "0:", 2) && !foundV1) {
+            out.assign(second + 1, pathEnd);
+            isV2 = true;
+            foundV2 = true;
+        }
+    });
+    return foundV1 || foundV2;
+}
+
+bool ParseCgroupBytes(const std::string& contents, uint64_t& out)
+{
+    const char* p = contents.data();
+    const char* end = p + contents.size();
+    while (p < end && (IsSpace(*p) || *p == '\n'))
+        ++p;
+    if (end - p >= 3 && !strncmp(p, "max", 3)) {
+        out = std::numeric_limits<uint64_t>::max();
+        return true;
+    }
+    return ParseUnsigned(p, end, out);
+}
+
+bool ParsePsi(const std::string& contents, PsiSample& out)
+{
+    bool hasSome = false;
+    ForEachLine(contents, [&](const char* line, size_t length) {
+        const char* end = line + length;
+        if (StartsWith(line, length, "some "))
+            hasSome = FindDouble(line + 5, end, "avg10", out.someAvg10);
+        else if (StartsWith(line, length, "full ") && !FindDouble(line + 5, end, "avg10", out.fullAvg10))
+            out.fullAvg10 = 0;
+    });
+    return hasSome;
+}
+
+Reading Combine(const MeminfoSample& meminfo, uint64_t cgroupLimitBytes, uint64_t cgroupUsageBytes)
+{
+    Reading reading;
+    reading.totalKb = meminfo.totalKb;
+    reading.availableKb = meminfo.availableKb;
+
+    const uint64_t limitKb = cgroupLimitBytes / 1024;
+    if (cgroupLimitBytes == std::numeric_limits<uint64_t>::max() || limitKb == 0 || limitKb >= meminfo.totalKb)
+        return reading;
+
+    const uint64_t usageKb = cgroupUsageBytes / 1024;
+    const uint64_t cgroupAvailableKb = usageKb < limitKb ? limitKb - usageKb : 0;
+    reading.totalKb = limitKb;
+    if (cgroupAvailableKb < reading.availableKb)
+        reading.availableKb = cgroupAvailableKb;
+    return reading;
+}
+
+Level Evaluate(const Reading& reading, const Thresholds& thresholds, Level current) noexcept
+{
+    // Thresholds of the levels held so far, lowered by the release margin.
+    const auto usedThreshold = [&](uint32_t pct, Level of) -> uint32_t {
+        if (current < of)
+            return pct;
+        return pct > thresholds.releaseMarginPct ? pct - thresholds.releaseMarginPct : 0;
+    };
+    const auto psiThreshold = [&](double avg10, Level of) { return current < of ? avg10 : avg10 / 2; };
+
+    Level level = Level::None;
+    if (reading.totalKb > 0) {
+        const uint64_t usedKb = reading.totalKb - (reading.availableKb < reading.totalKb ? reading.availableKb : reading.totalKb);
+        const uint64_t usedPct = usedKb * 100 / reading.totalKb;
+        if (usedPct >= usedThreshold(thresholds.criticalUsedPct, Level::Critical))
+            level = Level::Critical;
+        else if (usedPct >= usedThreshold(thresholds.nonCriticalUsedPct, Level::NonCritical))
+            level = Level::NonCritical;
+    }
+
+    if (reading.hasPsi && level != Level::Critical) {
+        if (thresholds.criticalPsiFull > 0 && reading.psi.fullAvg10 >= psiThreshold(thresholds.criticalPsiFull, Level::Critical))
+            level = Level::Critical;
+        else if (thresholds.nonCriticalPsiSome > 0
+            && reading.psi.someAvg10 >= psiThreshold(thresholds.nonCriticalPsiSome, Level::NonCritical))
+            level = Level::NonCritical;
+    }
+    return level;
+}
+
+} // namespace MemoryPressure
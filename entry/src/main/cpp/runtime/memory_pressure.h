@@ -0,0 +1,105 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/*
+ * Parsers and the pressure decision behind MemoryPressureMonitor. They take
+ * file contents rather than paths and depend on nothing but the C++ library,
+ * so the host tests (benchmarks/memory_pressure_test.cpp) run them on
+ * captured /proc and cgroup files.
+ *
+ * The meminfo parser reads line by line and skips anything it cannot use:
+ * fields without a number, unknown units, lines without a colon. WebKit's own
+ * parser does not advance past such a line, which is why it spins on OHOS and
+ * is disabled in Environment::Initialize.
+ */
+namespace MemoryPressure {
+
+enum class Level {
+    None,
+    NonCritical,
+    Critical,
+};
+
+const char* LevelName(Level level) noexcept;
+
+struct MeminfoSample {
+    uint64_t totalKb = 0;
+    uint64_t availableKb = 0;
+    // False when MemAvailable was missing and availableKb was estimated from
+    // the free and reclaimable fields.
+    bool hasMemAvailable = false;
+};
+
+// False if the contents have no MemTotal or nothing to derive the available
+// memory from.
+bool ParseMeminfo(const std::string& contents, MeminfoSample& out);
+
+// The memory cgroup path of a /proc/<pid>/cgroup file: the v1 "memory"
+// controller's, else the v2 unified one's ("0::"). False if neither is listed.
+bool ParseCgroupPath(const std::string& contents, std::string& out, bool& isV2);
+
+// A cgroup memory file holding one byte count (memory.max, memory.current,
+// memory.limit_in_bytes, ...). "max" parses as UINT64_MAX, meaning no limit.
+bool ParseCgroupBytes(const std::string& contents, uint64_t& out);
+
+struct PsiSample {
+    // Percentage of the last 10 s in which some / all tasks stalled on memory.
+    double someAvg10 = 0;
+    double fullAvg10 = 0;
+};
+
+// /proc/pressure/memory. False without a "some" line; kernels before 5.2
+// have no PSI at all.
+bool ParsePsi(const std::string& contents, PsiSample& out);
+
+struct Reading {
+    // Memory the app can use: the smaller of the system and its cgroup.
+    uint64_t totalKb = 0;
+    uint64_t availableKb = 0;
+    bool hasPsi = false;
+    PsiSample psi;
+};
+
+// Narrows a meminfo reading to a cgroup limit and usage, in bytes; a limit of
+// UINT64_MAX or above MemTotal changes nothing.
+Reading Combine(const MeminfoSample& meminfo, uint64_t cgroupLimitBytes, uint64_t cgroupUsageBytes);
+
+struct Thresholds {
+    // Used memory, in percent of Reading::totalKb. The defaults are those of
+    // WebKit's UIProcess MemoryPressureMonitor.
+    uint32_t nonCriticalUsedPct = 90;
+    uint32_t criticalUsedPct = 95;
+    // PSI stall percentages (avg10); 0 ignores PSI.
+    double nonCriticalPsiSome = 10;
+    double criticalPsiFull = 5;
+    // A level is left only once used memory is this many points below its
+    // threshold (and PSI below half of its), so a reading hovering around a
+    // threshold does not raise the level again on every poll.
+    uint32_t releaseMarginPct = 5;
+};
+
+// `current` is the level of the previous reading, which the release margin
+// applies to.
+Level Evaluate(const Reading& reading, const Thresholds& thresholds, Level current = Level::None) noexcept;
+
+} // namespace MemoryPressure
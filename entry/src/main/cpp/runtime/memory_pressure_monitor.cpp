@@ -0,0 +1,182 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "memory_pressure_monitor.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "log.h"
+
+namespace {
+
+constexpr const char* kMeminfoPath = "/proc/meminfo";
+constexpr const char* kCgroupPath = "/proc/self/cgroup";
+constexpr const char* kPsiPath = "/proc/pressure/memory";
+
+bool ReadFile(const char* path, std::string& out)
+{
+    // /proc files report a size of 0; g_file_get_contents reads to EOF.
+    gchar* contents = nullptr;
+    gsize length = 0;
+    if (!g_file_get_contents(path, &contents, &length, nullptr))
+        return false;
+    out.assign(contents, length);
+    g_free(contents);
+    return true;
+}
+
+} // namespace
+
+void MemoryPressureMonitor::Start(uint32_t intervalMs, const MemoryPressure::Thresholds& thresholds, Handler handler)
+{
+    if (intervalMs == 0 || source_ != 0)
+        return;
+
+    std::string contents;
+    MemoryPressure::MeminfoSample meminfo;
+    if (!ReadFile(kMeminfoPath, contents) || !MemoryPressure::ParseMeminfo(contents, meminfo)) {
+        LOGE("MemoryPressureMonitor - %{public}s is unreadable; monitor off", kMeminfoPath);
+        return;
+    }
+
+    std::string cgroup;
+    bool isV2 = false;
+    if (ReadFile(kCgroupPath, contents) && MemoryPressure::ParseCgroupPath(contents, cgroup, isV2)) {
+        const std::string dir = (isV2 ? "/sys/fs/cgroup" : "/sys/fs/cgroup/memory") + cgroup;
+        const std::string limitPath = dir + (isV2 ? "/memory.max" : "/memory.limit_in_bytes");
+        const std::string usagePath = dir + (isV2 ? "/memory.current" : "/memory.usage_in_bytes");
+        uint64_t bytes = 0;
+        if (ReadFile(limitPath.c_str(), contents) && MemoryPressure::ParseCgroupBytes(contents, bytes)) {
+            cgroupLimitPath_ = limitPath;
+            cgroupUsagePath_ = usagePath;
+        }
+    }
+
+    MemoryPressure::PsiSample psi;
+    hasPsi_ = ReadFile(kPsiPath, contents) && MemoryPressure::ParsePsi(contents, psi);
+
+    LOGD("MemoryPressureMonitor - every %{public}u ms; meminfo %{public}s, cgroup %{public}s, psi %{public}s",
+        intervalMs, meminfo.hasMemAvailable ? "MemAvailable" : "estimated",
+        cgroupLimitPath_.empty() ? "none" : cgroupLimitPath_.c_str(), hasPsi_ ? "yes" : "no");
+
+    thresholds_ = thresholds;
+    handler_ = handler;
+    intervalMs_.store(intervalMs, std::memory_order_relaxed);
+    // Below default priority: a late sample is fine, a delayed frame is not.
+    source_ = g_timeout_add_full(G_PRIORITY_LOW, intervalMs, MemoryPressureMonitor::OnPoll, this, nullptr);
+    g_source_set_name_by_id(source_, "MemoryPressureMonitor");
+    Poll();
+}
+
+void MemoryPressureMonitor::Stop()
+{
+    if (source_ != 0) {
+        g_source_remove(source_);
+        source_ = 0;
+    }
+    intervalMs_.store(0, std::memory_order_relaxed);
+}
+
+gboolean MemoryPressureMonitor::OnPoll(gpointer userData)
+{
+    static_cast<MemoryPressureMonitor*>(userData)->Poll();
+    return G_SOURCE_CONTINUE;
+}
+
+bool MemoryPressureMonitor::Read(MemoryPressure::Reading& reading) const
+{
+    std::string contents;
+    MemoryPressure::MeminfoSample meminfo;
+    if (!ReadFile(kMeminfoPath, contents) || !MemoryPressure::ParseMeminfo(contents, meminfo))
+        return false;
+
+    uint64_t limit = UINT64_MAX;
+    uint64_t usage = 0;
+    if (!cgroupLimitPath_.empty()
+        && !(ReadFile(cgroupLimitPath_.c_str(), contents) && MemoryPressure::ParseCgroupBytes(contents, limit)
+            && ReadFile(cgroupUsagePath_.c_str(), contents) && MemoryPressure::ParseCgroupBytes(contents, usage)))
+        limit = UINT64_MAX;
+    reading = MemoryPressure::Combine(meminfo, limit, usage);
+
+    if (hasPsi_)
+        reading.hasPsi = ReadFile(kPsiPath, contents) && MemoryPressure::ParsePsi(contents, reading.psi);
+    return true;
+}
+
+void MemoryPressureMonitor::Poll()
+{
+    MemoryPressure::Reading reading;
+    if (!Read(reading))
+        return;
+
+    const MemoryPressure::Level level = MemoryPressure::Evaluate(reading, thresholds_, level_);
+    {
+        std::lock_guard<std::mutex> lock(readingMutex_);
+        lastReading_ = reading;
+        lastLevel_ = level;
+    }
+
+    const MemoryPressure::Level previous = level_;
+    level_ = level;
+    if (level == MemoryPressure::Level::None && previous != MemoryPressure::Level::None) {
+        LOGD("MemoryPressureMonitor - pressure over: %{public}" PRIu64 " of %{public}" PRIu64 " kB available",
+            reading.availableKb, reading.totalKb);
+        if (handler_ != nullptr)
+            handler_(level);
+        return;
+    }
+    if (level <= previous)
+        return;
+
+    if (level == MemoryPressure::Level::Critical)
+        criticalEvents_.fetch_add(1, std::memory_order_relaxed);
+    else
+        nonCriticalEvents_.fetch_add(1, std::memory_order_relaxed);
+    LOGD("MemoryPressureMonitor - %{public}s pressure: %{public}" PRIu64 " of %{public}" PRIu64 " kB available",
+        MemoryPressure::LevelName(level), reading.availableKb, reading.totalKb);
+    if (handler_ != nullptr)
+        handler_(level);
+}
+
+std::string MemoryPressureMonitor::ToJson() const
+{
+    MemoryPressure::Reading reading;
+    MemoryPressure::Level level;
+    {
+        std::lock_guard<std::mutex> lock(readingMutex_);
+        reading = lastReading_;
+        level = lastLevel_;
+    }
+
+    char psiSome[32] = "null";
+    char psiFull[32] = "null";
+    if (reading.hasPsi) {
+        snprintf(psiSome, sizeof(psiSome), "%.2f", reading.psi.someAvg10);
+        snprintf(psiFull, sizeof(psiFull), "%.2f", reading.psi.fullAvg10);
+    }
+
+    char buffer[320];
+    snprintf(buffer, sizeof(buffer),
+        "{\"level\":\"%s\",\"intervalMs\":%u,\"totalKb\":%" PRIu64 ",\"availableKb\":%" PRIu64
+        ",\"psiSome\":%s,\"psiFull\":%s,\"nonCriticalEvents\":%" PRIu64 ",\"criticalEvents\":%" PRIu64 "}",
+        MemoryPressure::LevelName(level), intervalMs_.load(std::memory_order_relaxed), reading.totalKb,
+        reading.availableKb, psiSome, psiFull, nonCriticalEvents_.load(std::memory_order_relaxed),
+        criticalEvents_.load(std::memory_order_relaxed));
+    return buffer;
+}
@@ -0,0 +1,85 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "memory_pressure.h"
+
+/*
+ * MemoryPressureMonitor stands in for WebKit's UIProcess memory pressure
+ * monitor, which is disabled on OHOS. Every interval it reads /proc/meminfo,
+ * the app's memory cgroup and /proc/pressure/memory (each optional but
+ * meminfo), evaluates the MemoryPressure thresholds and calls the handler
+ * whenever the level rises, and with None when it falls back to None. A level
+ * that drops and rises again calls it again.
+ *
+ * Start/Stop run on WebKit's thread, where the poll and the handler run too;
+ * ToJson on any thread.
+ */
+class MemoryPressureMonitor final {
+public:
+    // Sheds memory for `level` (NonCritical or Critical), or restores what
+    // was shed once the level is None again; on WebKit's thread.
+    using Handler = void (*)(MemoryPressure::Level level);
+
+    MemoryPressureMonitor() = default;
+
+    MemoryPressureMonitor(MemoryPressureMonitor&&) = delete;
+    MemoryPressureMonitor& operator=(MemoryPressureMonitor&&) = delete;
+    MemoryPressureMonitor(const MemoryPressureMonitor&) = delete;
+    MemoryPressureMonitor& operator=(const MemoryPressureMonitor&) = delete;
+
+    ~MemoryPressureMonitor() = default;
+
+    // intervalMs == 0 leaves the monitor off.
+    void Start(uint32_t intervalMs, const MemoryPressure::Thresholds& thresholds, Handler handler);
+    void Stop();
+
+    // {"level":"...","intervalMs":N,"totalKb":N,"availableKb":N,"psiSome":N|null,
+    //  "psiFull":N|null,"nonCriticalEvents":N,"criticalEvents":N}
+    std::string ToJson() const;
+
+private:
+    static gboolean OnPoll(gpointer userData);
+    void Poll();
+    bool Read(MemoryPressure::Reading& reading) const;
+
+    MemoryPressure::Thresholds thresholds_;
+    Handler handler_ = nullptr;
+    guint source_ = 0;
+    // Empty when the app's memory cgroup is unknown.
+    std::string cgroupLimitPath_;
+    std::string cgroupUsagePath_;
+    bool hasPsi_ = false;
+    MemoryPressure::Level level_ = MemoryPressure::Level::None;
+
+    std::atomic<uint32_t> intervalMs_ { 0 };
+    std::atomic<uint64_t> nonCriticalEvents_ { 0 };
+    std::atomic<uint64_t> criticalEvents_ { 0 };
+
+    mutable std::mutex readingMutex_;
+    MemoryPressure::Reading lastReading_;
+    MemoryPressure::Level lastLevel_ = MemoryPressure::Level::None;
+};
@@ -18,7 +18,11 @@
 
 #include "message_pump.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
+#include <unistd.h>
 
 #include "log.h"
 
@@ -55,10 +59,46 @@ gushort uvEventsToGlibEvents(int status, int events) noexcept
     return glibEvents;
 }
 
+uint32_t glibEventsToEpollEvents(gushort events) noexcept
+{
+    uint32_t epollEvents = 0;
+    if ((events & G_IO_IN) != 0)
+        epollEvents |= EPOLLIN;
+    if ((events & G_IO_OUT) != 0)
+        epollEvents |= EPOLLOUT;
+    if ((events & G_IO_PRI) != 0)
+        epollEvents |= EPOLLPRI;
+    // Same as UV_DISCONNECT above; EPOLLERR/EPOLLHUP are always reported.
+    epollEvents |= EPOLLRDHUP;
+    return epollEvents;
+}
+
+gushort epollEventsToGlibEvents(uint32_t events) noexcept
+{
+    gushort glibEvents = 0;
+    if ((events & EPOLLIN) != 0)
+        glibEvents |= G_IO_IN;
+    if ((events & EPOLLOUT) != 0)
+        glibEvents |= G_IO_OUT;
+    if ((events & EPOLLPRI) != 0)
+        glibEvents |= G_IO_PRI;
+    if ((events & (EPOLLHUP | EPOLLRDHUP)) != 0)
+        glibEvents |= G_IO_HUP;
+    if ((events & EPOLLERR) != 0)
+        glibEvents |= G_IO_ERR;
+    return glibEvents;
+}
+
 } // namespace
 
 MessagePump::MessagePump(uv_loop_t* loop)
+    : MessagePump(loop, Options {})
+{
+}
+
+MessagePump::MessagePump(uv_loop_t* loop, const Options& options)
     : m_loop(loop)
+    , m_options(options)
 {
     // Drive the same context WebKit's RunLoop::main uses on this (main) thread:
     // with no thread-default context pushed, that is the default context.
@@ -66,6 +106,8 @@ MessagePump::MessagePump(uv_loop_t* loop)
     if (!g_main_context_acquire(m_context))
         LOGE("MessagePump: failed to acquire the default GMainContext (owned by another thread?)");
 
+    m_invokeQueue = std::make_unique<InvokeQueue>(m_context);
+
     m_prepare = static_cast<uv_prepare_t*>(std::calloc(1, sizeof(uv_prepare_t)));
     m_check = static_cast<uv_check_t*>(std::calloc(1, sizeof(uv_check_t)));
     m_timer = static_cast<uv_timer_t*>(std::calloc(1, sizeof(uv_timer_t)));
@@ -93,6 +135,25 @@ MessagePump::MessagePump(uv_loop_t* loop)
     uv_unref(reinterpret_cast<uv_handle_t*>(m_timer));
     uv_unref(reinterpret_cast<uv_handle_t*>(m_async));
 
+    if (m_options.pollMode == PollMode::Epoll) {
+        m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+        m_epollHandle = static_cast<uv_poll_t*>(std::calloc(1, sizeof(uv_poll_t)));
+        if (m_epollFd < 0 || uv_poll_init(m_loop, m_epollHandle, m_epollFd) != 0) {
+            LOGE("MessagePump: epoll aggregation unavailable (%{public}s); polling GLib fds individually",
+                std::strerror(errno));
+            std::free(m_epollHandle);
+            m_epollHandle = nullptr;
+            if (m_epollFd >= 0)
+                close(m_epollFd);
+            m_epollFd = -1;
+            m_options.pollMode = PollMode::PerFd;
+        } else {
+            m_epollHandle->data = this;
+            uv_poll_start(m_epollHandle, UV_READABLE, &MessagePump::onEpollReadable);
+            uv_unref(reinterpret_cast<uv_handle_t*>(m_epollHandle));
+        }
+    }
+
     // Initial kick: on OHOS the main-thread uv loop is EventHandler-embedded and
     // only runs when its backend fd signals. The pump is constructed outside any
     // uv iteration (napi Init), so nothing would run the first prepare() that arms
@@ -105,12 +166,28 @@ MessagePump::~MessagePump()
     // Deliberately no final dispatch: check/dispatch without a fresh prepare
     // could re-deliver stale revents, and running arbitrary WebKit callbacks
     // during teardown (after WKRuntime has deleted its views) is unsafe.
+    // Likewise queued invocations are only destroyed, never run.
+    m_invokeQueue = nullptr;
+
+    for (const auto& registration : m_pollRegistrations) {
+        if (registration.handle == nullptr)
+            continue;
+        uv_poll_stop(registration.handle);
+        uv_close(reinterpret_cast<uv_handle_t*>(registration.handle), &MessagePump::onPollClose);
+    }
+    m_pollRegistrations.clear();
+    m_lastPollFds.clear();
 
-    for (auto& entry : m_pollHandles) {
-        uv_poll_stop(entry.second);
-        uv_close(reinterpret_cast<uv_handle_t*>(entry.second), &MessagePump::onPollClose);
+    if (m_epollHandle != nullptr) {
+        uv_poll_stop(m_epollHandle);
+        uv_close(reinterpret_cast<uv_handle_t*>(m_epollHandle), &MessagePump::onSimpleClose);
+        m_epollHandle = nullptr;
+    }
+    if (m_epollFd >= 0) {
+        // Closing the epoll instance drops every GLib fd registered in it.
+        close(m_epollFd);
+        m_epollFd = -1;
     }
-    m_pollHandles.clear();
 
     uv_prepare_stop(m_prepare);
     uv_check_stop(m_check);
@@ -168,6 +245,7 @@ void MessagePump::onPoll(uv_poll_t* handle, int status, int events)
     auto* ctx = static_cast<PollContext*>(handle->data);
     MessagePump* self = ctx->pump;
     const int fd = ctx->fd;
+    self->m_fdWakeup = true;
 
     const gushort revents = uvEventsToGlibEvents(status, events);
 
@@ -181,9 +259,56 @@ void MessagePump::onPoll(uv_poll_t* handle, int status, int events)
     }
 }
 
-void MessagePump::prepare() noexcept
+void MessagePump::onEpollReadable(uv_poll_t* handle, int, int)
 {
-    g_main_context_prepare(m_context, &m_maxPriority);
+    // Only note it: the check phase harvests every ready fd in one epoll_wait.
+    auto* self = static_cast<MessagePump*>(handle->data);
+    self->m_epollReadable = true;
+    self->m_fdWakeup = true;
+}
+
+void MessagePump::harvestEpollEvents() noexcept
+{
+    if (!m_epollReadable)
+        return;
+    m_epollReadable = false;
+
+    // Sized to the registration count (grows only with the fd set), so a
+    // single non-blocking epoll_wait returns everything that is ready.
+    if (m_epollEvents.size() < m_pollRegistrations.size())
+        m_epollEvents.resize(m_pollRegistrations.size());
+    if (m_epollEvents.empty())
+        return;
+
+    const int count = epoll_wait(m_epollFd, m_epollEvents.data(), static_cast<int>(m_epollEvents.size()), 0);
+    if (count <= 0)
+        return;
+
+    m_readyFds.clear();
+    for (int i = 0; i < count; ++i) {
+        // epoll_event is packed on some ABIs; copy the fields out by value.
+        const int fd = m_epollEvents[i].data.fd;
+        const uint32_t events = m_epollEvents[i].events;
+        m_readyFds.emplace_back(fd, epollEventsToGlibEvents(events));
+    }
+    std::sort(m_readyFds.begin(), m_readyFds.end());
+
+    // As in onPoll, an fd may back several GPollFD entries; mask each to the
+    // events its source requested.
+    for (gint i = 0; i < m_pollFdsSize; ++i) {
+        auto it = std::lower_bound(m_readyFds.begin(), m_readyFds.end(), std::make_pair(m_pollFds[i].fd, gushort(0)));
+        if (it == m_readyFds.end() || it->first != m_pollFds[i].fd)
+            continue;
+        const gushort mask = m_pollFds[i].events | G_IO_ERR | G_IO_HUP | G_IO_NVAL;
+        m_pollFds[i].revents |= (it->second & mask);
+    }
+}
+
+bool MessagePump::prepare() noexcept
+{
+    const uint64_t prepareStart = m_stats ? MessagePumpStats::now() : 0;
+    const bool ready = g_main_context_prepare(m_context, &m_maxPriority) == TRUE;
+    const uint64_t queryStart = m_stats ? MessagePumpStats::now() : 0;
 
     if (m_pollFds == nullptr) {
         m_pollFdsCapacity = 1; // There is always at least the context wakeup fd.
@@ -198,6 +323,13 @@ void MessagePump::prepare() noexcept
         m_pollFds = g_new(GPollFD, m_pollFdsCapacity);
     }
 
+    if (m_stats) {
+        const uint64_t queryEnd = MessagePumpStats::now();
+        m_stats->prepare.record(queryStart - prepareStart);
+        m_stats->query.record(queryEnd - queryStart);
+        m_stats->pollFds.record(static_cast<uint64_t>(m_pollFdsSize));
+    }
+
     // Reset revents; onPoll fills them in during the poll phase.
     for (gint i = 0; i < m_pollFdsSize; ++i)
         m_pollFds[i].revents = 0;
@@ -206,106 +338,328 @@ void MessagePump::prepare() noexcept
 
     // Bound the poll wait by the GLib timeout. timeout < 0 means "wait
     // forever" (until an fd fires); timeout == 0 means "dispatch immediately".
-    if (timeout < 0)
+    if (timeout < 0) {
         uv_timer_stop(m_timer);
-    else
-        uv_timer_start(m_timer, &MessagePump::onTimer, static_cast<uint64_t>(timeout), 0);
+        m_timerDeadline = 0;
+    } else {
+        const uint64_t delay = timeout > 0 ? slackTimeout(timeout) : 0;
+        uv_timer_start(m_timer, &MessagePump::onTimer, delay, 0);
+        m_timerDeadline = timeout > 0 ? uv_now(m_loop) + delay : 0;
+    }
+
+    return ready;
+}
+
+uint64_t MessagePump::slackTimeout(gint timeout) const noexcept
+{
+    const int64_t granularityUs = m_frameIntervalUs ? m_frameIntervalUs : m_options.timerSlackUs;
+    if (m_options.timerSlackUs == 0 || granularityUs == 0)
+        return static_cast<uint64_t>(timeout);
+
+    // GLib only reports the earliest deadline of all its sources, so the
+    // slack applies to whichever source that is. Round it up onto the grid
+    // (anchored at the last frame, or at 0). Timers landing in the same grid
+    // slot then expire on the same loop tick.
+    const int64_t nowUs = g_get_monotonic_time();
+    const int64_t deadlineUs = nowUs + static_cast<int64_t>(timeout) * 1000;
+    int64_t phase = (deadlineUs - m_frameTimeUs) % granularityUs;
+    if (phase < 0)
+        phase += granularityUs;
+    const int64_t alignedUs = phase ? deadlineUs + (granularityUs - phase) : deadlineUs;
+
+    // uv timers are due against uv_now(), which is cached at the start of the
+    // loop iteration, truncated to milliseconds and may come from
+    // CLOCK_MONOTONIC_COARSE, so it lags the real time. Anchor the due time
+    // at libuv's precise clock instead, rounded up, plus the time left to the
+    // aligned deadline, also rounded up: the uv timer can then only be due
+    // once that deadline has passed.
+    const uint64_t remainingMs = static_cast<uint64_t>((alignedUs - nowUs + 999) / 1000);
+    const uint64_t dueMs = (uv_hrtime() + 999999) / 1000000 + remainingMs;
+    const uint64_t now = uv_now(m_loop);
+    return dueMs > now ? dueMs - now : static_cast<uint64_t>(timeout);
+}
+
+void MessagePump::pollReadyFds() noexcept
+{
+    // Non-blocking readiness refresh for another GLib iteration inside the
+    // same check phase, where libuv's poll phase has not run in between.
+    if (m_options.pollMode == PollMode::Epoll) {
+        m_epollReadable = true;
+        harvestEpollEvents();
+        return;
+    }
+    GPollFunc poll = g_main_context_get_poll_func(m_context);
+    poll(m_pollFds, static_cast<guint>(m_pollFdsSize), 0);
 }
 
 void MessagePump::updatePollHandles() noexcept
 {
-    // Desired fd -> combined GLib events for this iteration.
-    std::unordered_map<int, gushort> desired;
+    // Wanted fd -> combined GLib events for this iteration, sorted by fd. A
+    // single fd may back several GPollFD entries (different sources).
+    m_pollScratch.clear();
     for (gint i = 0; i < m_pollFdsSize; ++i)
-        desired[m_pollFds[i].fd] |= m_pollFds[i].events;
-
-    // Drop handles for fds GLib no longer polls.
-    for (auto it = m_pollHandles.begin(); it != m_pollHandles.end();) {
-        if (desired.find(it->first) == desired.end()) {
-            uv_poll_stop(it->second);
-            uv_close(reinterpret_cast<uv_handle_t*>(it->second), &MessagePump::onPollClose);
-            it = m_pollHandles.erase(it);
-        } else {
-            ++it;
+        m_pollScratch.push_back({ m_pollFds[i].fd, m_pollFds[i].events, nullptr });
+    std::sort(m_pollScratch.begin(), m_pollScratch.end(),
+        [](const PollRegistration& a, const PollRegistration& b) { return a.fd < b.fd; });
+    size_t wantedCount = 0;
+    for (const auto& entry : m_pollScratch) {
+        if (wantedCount > 0 && m_pollScratch[wantedCount - 1].fd == entry.fd)
+            m_pollScratch[wantedCount - 1].events |= entry.events;
+        else
+            m_pollScratch[wantedCount++] = entry;
+    }
+    m_pollScratch.resize(wantedCount);
+
+    // A kept fd number may be a different file by now: closing the old one
+    // dropped it from the kernel's epoll set (ours, or libuv's), and GLib
+    // reopened the number between two iterations. Same number, same events,
+    // so the merge below sees no change. Such a swap replaces a GLib source,
+    // which changes GLib's fd list, so kept registrations are checked
+    // whenever the list differs from the last one.
+    bool revalidate = static_cast<size_t>(m_pollFdsSize) != m_lastPollFds.size();
+    for (gint i = 0; !revalidate && i < m_pollFdsSize; ++i)
+        revalidate = m_lastPollFds[i].first != m_pollFds[i].fd || m_lastPollFds[i].second != m_pollFds[i].events;
+    if (revalidate) {
+        m_lastPollFds.clear();
+        for (gint i = 0; i < m_pollFdsSize; ++i)
+            m_lastPollFds.emplace_back(m_pollFds[i].fd, m_pollFds[i].events);
+    }
+
+    // Merge against last iteration's registrations (also sorted): keep
+    // unchanged handles untouched, re-arm only on an event-mask change, and
+    // add/drop handles for fds that appeared/disappeared.
+    auto current = m_pollRegistrations.cbegin();
+    const auto end = m_pollRegistrations.cend();
+    // Registrations that failed are flagged fd = -1 and left out; the next
+    // iteration retries them.
+    for (auto& wanted : m_pollScratch) {
+        for (; current != end && current->fd < wanted.fd; ++current)
+            removePollRegistration(*current);
+
+        if (current != end && current->fd == wanted.fd) {
+            wanted.handle = current->handle;
+            if (current->events != wanted.events)
+                rearmPollRegistration(wanted);
+            else if (revalidate)
+                revalidatePollRegistration(wanted);
+            ++current;
+        } else if (!addPollRegistration(wanted)) {
+            wanted.fd = -1;
         }
     }
+    for (; current != end; ++current)
+        removePollRegistration(*current);
 
-    // Add new fds and (re)arm existing ones with the current event mask.
-    for (const auto& entry : desired) {
-        const int fd = entry.first;
-        const int uvEvents = glibEventsToUvEvents(entry.second);
-
-        uv_poll_t* handle = nullptr;
-        auto it = m_pollHandles.find(fd);
-        if (it == m_pollHandles.end()) {
-            handle = static_cast<uv_poll_t*>(std::calloc(1, sizeof(uv_poll_t)));
-            if (uv_poll_init(m_loop, handle, fd) != 0) {
-                LOGE("MessagePump: uv_poll_init failed for fd %{public}d", fd);
-                std::free(handle);
-                continue;
-            }
-            handle->data = new PollContext { this, fd };
-            uv_unref(reinterpret_cast<uv_handle_t*>(handle));
-            m_pollHandles.emplace(fd, handle);
-        } else {
-            handle = it->second;
+    m_pollScratch.erase(std::remove_if(m_pollScratch.begin(), m_pollScratch.end(),
+        [](const PollRegistration& registration) { return registration.fd < 0; }), m_pollScratch.end());
+    m_pollRegistrations.swap(m_pollScratch);
+}
+
+bool MessagePump::addPollRegistration(PollRegistration& registration) noexcept
+{
+    const int fd = registration.fd;
+    if (m_options.pollMode == PollMode::Epoll) {
+        struct epoll_event event = {};
+        event.events = glibEventsToEpollEvents(registration.events);
+        event.data.fd = fd;
+        // EEXIST: GLib closed and reused this fd number between iterations
+        // without the old registration being dropped by the kernel.
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) != 0
+            && (errno != EEXIST || epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &event) != 0)) {
+            LOGE("MessagePump: epoll_ctl(ADD) failed for fd %{public}d: %{public}s", fd, std::strerror(errno));
+            return false;
         }
-        uv_poll_start(handle, uvEvents, &MessagePump::onPoll);
+        ++m_pollHandleStats.adds;
+        return true;
+    }
+
+    auto* handle = static_cast<uv_poll_t*>(std::calloc(1, sizeof(uv_poll_t)));
+    if (uv_poll_init(m_loop, handle, fd) != 0) {
+        LOGE("MessagePump: uv_poll_init failed for fd %{public}d", fd);
+        std::free(handle);
+        return false;
+    }
+    handle->data = new PollContext { this, fd };
+    uv_unref(reinterpret_cast<uv_handle_t*>(handle));
+    uv_poll_start(handle, glibEventsToUvEvents(registration.events), &MessagePump::onPoll);
+    registration.handle = handle;
+    ++m_pollHandleStats.adds;
+    return true;
+}
+
+void MessagePump::removePollRegistration(const PollRegistration& registration) noexcept
+{
+    if (m_options.pollMode == PollMode::Epoll) {
+        // Fails with EBADF once GLib has already closed the fd, in which case
+        // the kernel has dropped it from the epoll set by itself.
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, registration.fd, nullptr);
+    } else {
+        uv_poll_stop(registration.handle);
+        uv_close(reinterpret_cast<uv_handle_t*>(registration.handle), &MessagePump::onPollClose);
+    }
+    ++m_pollHandleStats.removes;
+}
+
+void MessagePump::rearmPollRegistration(const PollRegistration& registration) noexcept
+{
+    if (m_options.pollMode == PollMode::Epoll) {
+        modifyEpollRegistration(registration);
+    } else {
+        uv_poll_start(registration.handle, glibEventsToUvEvents(registration.events), &MessagePump::onPoll);
+    }
+    ++m_pollHandleStats.rearms;
+}
+
+void MessagePump::revalidatePollRegistration(const PollRegistration& registration) noexcept
+{
+    ++m_pollHandleStats.revalidations;
+    if (m_options.pollMode == PollMode::Epoll) {
+        modifyEpollRegistration(registration);
+        return;
     }
+
+    // Ask libuv's epoll set whether it still holds this fd: EEXIST means the
+    // file libuv registered is still open under the number, and nothing
+    // changes. Otherwise the probe added the new file; take it out again and
+    // restart the watcher. libuv only re-registers a watcher whose events
+    // changed, and stopping it resets them.
+    const int backendFd = uv_backend_fd(m_loop);
+    struct epoll_event event = {};
+    event.data.fd = registration.fd;
+    if (epoll_ctl(backendFd, EPOLL_CTL_ADD, registration.fd, &event) != 0)
+        return;
+    epoll_ctl(backendFd, EPOLL_CTL_DEL, registration.fd, nullptr);
+    uv_poll_stop(registration.handle);
+    uv_poll_start(registration.handle, glibEventsToUvEvents(registration.events), &MessagePump::onPoll);
+    ++m_pollHandleStats.readds;
+}
+
+void MessagePump::modifyEpollRegistration(const PollRegistration& registration) noexcept
+{
+    // ENOENT: the fd is a new file under a reused number; the old one left
+    // the epoll set when it was closed.
+    struct epoll_event event = {};
+    event.events = glibEventsToEpollEvents(registration.events);
+    event.data.fd = registration.fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, registration.fd, &event) == 0 || errno != ENOENT)
+        return;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, registration.fd, &event) != 0) {
+        LOGE("MessagePump: epoll_ctl(ADD) failed for fd %{public}d: %{public}s", registration.fd, std::strerror(errno));
+        return;
+    }
+    ++m_pollHandleStats.readds;
 }
 
 void MessagePump::dispatch() noexcept
 {
-    if (g_main_context_check(m_context, m_maxPriority, m_pollFds, m_pollFdsSize) == TRUE)
-        g_main_context_dispatch(m_context);
-
-    // Re-arm: sources attached during dispatch (idle posts, WebKit timeouts)
-    // get no wakeup — GLib only signals the wakeup fd for non-owner-thread
-    // attaches — and postdate the uv_timer from the pre-dispatch prepare().
-    // Running prepare() again arms a fresh timeout/fd set so they fire on time.
-    prepare();
+    // The uv_timer callback itself rarely runs (this check phase re-arms the
+    // timer before libuv's next timer phase), so an expired GLib timeout is
+    // recognised by its deadline.
+    if (m_stats)
+        m_stats->recordWakeup(m_fdWakeup, m_timerDeadline != 0 && uv_now(m_loop) >= m_timerDeadline);
+    m_fdWakeup = false;
+
+    if (m_watchdog)
+        m_watchdog->dispatchStarted();
+
+    if (m_options.pollMode == PollMode::Epoll)
+        harvestEpollEvents();
+
+    const bool budgeted = m_options.dispatchBudgetUs > 0;
+    const gint64 start = budgeted ? g_get_monotonic_time() : 0;
+    const gint64 deadline = start + static_cast<gint64>(m_options.dispatchBudgetUs);
+    uint64_t iterations = 0;
+    bool yielded = false;
+
+    // The invoke queue stops between tasks once the budget is spent and
+    // leaves the rest for the next check phase. Other sources' dispatches
+    // cannot be cut short, so the deadline is checked between iterations.
+    if (budgeted)
+        m_invokeQueue->setDeadline(deadline);
+
+    for (;;) {
+        if (m_stats)
+            checkAndDispatchInstrumented();
+        else if (g_main_context_check(m_context, m_maxPriority, m_pollFds, m_pollFdsSize) == TRUE)
+            g_main_context_dispatch(m_context);
+        ++iterations;
+
+        // Re-arm: sources attached during dispatch (idle posts, WebKit timeouts)
+        // get no wakeup — GLib only signals the wakeup fd for non-owner-thread
+        // attaches — and postdate the uv_timer from the pre-dispatch prepare().
+        // Running prepare() again arms a fresh timeout/fd set so they fire on time.
+        const bool ready = prepare();
+        if (!budgeted || !ready)
+            break;
+
+        // More GLib work is ready. Within budget, run it now rather than after
+        // a full uv round trip; past it, yield. prepare() has armed a zero
+        // timeout, so libuv comes straight back after servicing its own work.
+        if (g_get_monotonic_time() >= deadline) {
+            yielded = true;
+            break;
+        }
+        pollReadyFds();
+    }
+
+    // A nested iteration (outside this check phase) drains without a limit.
+    if (budgeted)
+        m_invokeQueue->setDeadline(0);
+
+    if (m_watchdog)
+        m_watchdog->dispatchFinished();
+
+    if (!budgeted)
+        return;
+
+    const auto elapsedUs = static_cast<uint64_t>(g_get_monotonic_time() - start);
+    m_dispatchBudgetStats.iterations += iterations;
+    ++m_dispatchBudgetStats.checkPhases;
+    if (yielded)
+        ++m_dispatchBudgetStats.yields;
+    if (elapsedUs > m_options.dispatchBudgetUs) {
+        ++m_dispatchBudgetStats.overruns;
+        if (elapsedUs > m_dispatchBudgetStats.maxOverrunUs)
+            m_dispatchBudgetStats.maxOverrunUs = elapsedUs;
+    }
 }
 
-void MessagePump::invoke(void (*onExec)(void*), void (*onDestroy)(void*), void* userData) const noexcept
+void MessagePump::checkAndDispatchInstrumented() noexcept
 {
-    struct InvocationInfo {
-        void (*m_onExec)(void*);
-        void (*m_onDestroy)(void*);
-        void* m_userData;
-    };
-
-    auto* info = new InvocationInfo { onExec, onDestroy, userData };
-    // Attach an explicit idle source instead of g_main_context_invoke_full:
-    // invoke_full runs the callback INLINE when the calling thread owns the
-    // context (this pump acquires it at construction), which would silently
-    // turn same-thread posts into synchronous calls. An attached source is
-    // always deferred to a future dispatch, keeping posts asynchronous.
-    GSource* source = g_idle_source_new();
-    g_source_set_priority(source, G_PRIORITY_DEFAULT);
-    g_source_set_callback(
-        source,
-        +[](gpointer data) -> gboolean {
-            auto* invocation = static_cast<InvocationInfo*>(data);
-            if (invocation->m_onExec != nullptr)
-                invocation->m_onExec(invocation->m_userData);
-            return G_SOURCE_REMOVE;
-        },
-        info,
-        +[](gpointer data) -> void {
-            auto* invocation = static_cast<InvocationInfo*>(data);
-            if (invocation->m_onDestroy != nullptr)
-                invocation->m_onDestroy(invocation->m_userData);
-            delete invocation;
-        });
-    g_source_attach(source, m_context);
-    g_source_unref(source);
-
-    // GLib does NOT signal the context wakeup fd when the attaching thread owns
-    // the context (this pump acquired it on the loop thread), so a same-thread
-    // invoke would otherwise sit unnoticed until an unrelated event. Wake both
-    // layers explicitly: the GLib wakeup fd (observed by our uv_poll once the
-    // first prepare has armed it) and the uv loop itself (works even before the
-    // first iteration, and from any thread).
-    g_main_context_wakeup(m_context);
-    uv_async_send(m_async);
+    ++m_stats->iterations;
+
+    const uint64_t checkStart = MessagePumpStats::now();
+    const bool ready = g_main_context_check(m_context, m_maxPriority, m_pollFds, m_pollFdsSize) == TRUE;
+    m_stats->check.record(MessagePumpStats::now() - checkStart);
+    if (!ready)
+        return;
+
+    m_stats->beginDispatch();
+    g_main_context_dispatch(m_context);
+    m_stats->endDispatch();
+}
+
+void MessagePump::setStatsEnabled(bool enabled)
+{
+    if (enabled)
+        m_stats = std::make_unique<MessagePumpStats>();
+    else
+        m_stats.reset();
+    m_invokeQueue->setStats(m_stats.get());
+}
+
+void MessagePump::enableStallWatchdog(const StallWatchdog::Options& options)
+{
+    // Stop the old watchdog first; only one capture handler target at a time.
+    m_watchdog = nullptr;
+    m_watchdog = std::make_unique<StallWatchdog>(options);
+}
+
+void MessagePump::invoke(InvokeTask&& task) noexcept
+{
+    // The queue wakes the GLib context (observed by our uv_poll once the first
+    // prepare has armed it); also wake the uv loop itself, which works even
+    // before the first iteration.
+    if (m_invokeQueue->post(std::move(task)))
+        uv_async_send(m_async);
 }
@@ -19,9 +19,18 @@
 #pragma once
 
 #include <glib.h>
+#include <sys/epoll.h>
 #include <uv.h>
 
-#include <unordered_map>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "invoke_queue.h"
+#include "invoke_task.h"
+#include "pump_stats.h"
+#include "stall_watchdog.h"
 
 /*
  * MessagePump integrates the GLib main context into a libuv event loop so that
@@ -42,11 +51,45 @@
  *   uv "poll"    phase  ->  libuv blocks on those fds / the timer.
  *   uv "check"   phase  ->  g_main_context_check + g_main_context_dispatch.
  *
+ * With PollMode::Epoll the GLib fds are instead collected in one private epoll
+ * instance and only its fd is registered with libuv; readiness is harvested
+ * with a single epoll_wait at the start of the check phase.
+ *
  * All methods must be called on the thread that owns the libuv loop.
  */
 class MessagePump final {
 public:
+    enum class PollMode {
+        // One uv_poll handle per GLib fd.
+        PerFd,
+        // One private epoll fd aggregating every GLib fd; one uv_poll total.
+        Epoll,
+    };
+
+    struct Options {
+        PollMode pollMode = PollMode::PerFd;
+        // Time budget for GLib work per uv check phase, in microseconds. 0
+        // runs exactly one GLib iteration per check phase, which drains up to
+        // a full batch of invoke() tasks. Otherwise the invoke queue stops
+        // between tasks once the budget is spent, and the pump keeps running
+        // iterations (ready sources, highest priority first) only while GLib
+        // has work ready and budget is left; then it yields to libuv and
+        // resumes on the next loop iteration. The dispatch of any other
+        // single source cannot be interrupted, so one long callback can still
+        // exceed the budget; such check phases count as overruns.
+        uint32_t dispatchBudgetUs = 0;
+        // Timer slack in microseconds; 0 arms GLib's timeout exactly. Otherwise
+        // a GLib timeout is rounded up to the next multiple of this interval
+        // (on the monotonic clock), or to the next frame boundary once
+        // setFrameTiming() has been called, so that unrelated timers expiring
+        // close together share one wakeup. A timer fires at most one interval
+        // late and never early. Work that is already ready (zero timeout), fd
+        // activity and invoke() are never delayed.
+        uint32_t timerSlackUs = 0;
+    };
+
     explicit MessagePump(uv_loop_t* loop);
+    MessagePump(uv_loop_t* loop, const Options& options);
 
     MessagePump(MessagePump&&) = delete;
     MessagePump& operator=(MessagePump&&) = delete;
@@ -55,20 +98,96 @@ public:
 
     ~MessagePump();
 
-    // Queue a callback to run on the GLib (== libuv) thread. Thread-safe: it
-    // wakes the GLib context, whose wakeup fd is observed by libuv. Always
-    // deferred to a future dispatch, even when called on the loop thread.
-    void invoke(void (*onExec)(void*), void (*onDestroy)(void*), void* userData) const noexcept;
+    // Queue a callback to run on the GLib (== libuv) thread. Thread-safe and
+    // lock-free in the common case: one CAS into the invoke queue, plus one
+    // wakeup for the first post of a batch. Always deferred to a future
+    // dispatch, even when called on the loop thread, and FIFO per posting
+    // thread.
+    // A task dropped unrun (pump teardown) is destroyed without being called.
+    void invoke(InvokeTask&& task) noexcept;
+
+    // Cumulative registration churn caused by changes in GLib's fd set: uv_poll
+    // handles in PollMode::PerFd, epoll_ctl calls in PollMode::Epoll. On a
+    // steady page all four stay flat from one iteration to the next.
+    struct PollHandleStats {
+        uint64_t adds = 0;
+        uint64_t removes = 0;
+        uint64_t rearms = 0;
+        // Kept registrations checked after GLib's fd list changed, in case
+        // their fd number now names another file, and those that did and
+        // were registered again.
+        uint64_t revalidations = 0;
+        uint64_t readds = 0;
+    };
+    const PollHandleStats& pollHandleStats() const noexcept { return m_pollHandleStats; }
+
+    // Cumulative check-phase accounting for Options::dispatchBudgetUs; only
+    // maintained when a budget is set.
+    struct DispatchBudgetStats {
+        // GLib iterations run, and uv check phases that ran them.
+        uint64_t iterations = 0;
+        uint64_t checkPhases = 0;
+        // Check phases that stopped with GLib work still ready because the
+        // budget was spent.
+        uint64_t yields = 0;
+        // Check phases whose GLib work took longer than the budget, and the
+        // worst such duration.
+        uint64_t overruns = 0;
+        uint64_t maxOverrunUs = 0;
+    };
+    const DispatchBudgetStats& dispatchBudgetStats() const noexcept { return m_dispatchBudgetStats; }
+
+    // Frame clock for Options::timerSlackUs: a recent frame (vsync) time on
+    // the g_get_monotonic_time() clock and the frame interval, both in
+    // microseconds. Slack then rounds GLib timeouts to frame boundaries
+    // instead of multiples of timerSlackUs; an interval of 0 reverts to that.
+    // No effect while timerSlackUs is 0. WKRuntime calls this with the time of
+    // every frame a view presents.
+    void setFrameTiming(int64_t frameTimeUs, uint32_t frameIntervalUs) noexcept
+    {
+        m_frameTimeUs = frameTimeUs;
+        m_frameIntervalUs = frameIntervalUs;
+    }
+
+    // Opt-in phase timing histograms, wakeup/fd counters and per-source
+    // dispatch attribution (see MessagePumpStats). Enabling starts from a
+    // clean slate; stats() is null while disabled.
+    void setStatsEnabled(bool enabled);
+    const MessagePumpStats* stats() const noexcept { return m_stats.get(); }
+
+    // Reports dispatches that keep this thread busy for longer than
+    // options.thresholdMs (see StallWatchdog). Replaces any running watchdog.
+    void enableStallWatchdog(const StallWatchdog::Options& options);
+    void disableStallWatchdog() noexcept { m_watchdog = nullptr; }
+    const StallWatchdog* stallWatchdog() const noexcept { return m_watchdog.get(); }
 
 private:
-    void prepare() noexcept;
+    // One registration per distinct GLib fd, with the union of the events GLib
+    // asked for on it. `handle` is only used in PollMode::PerFd.
+    struct PollRegistration {
+        int fd;
+        gushort events;
+        uv_poll_t* handle;
+    };
+
+    bool prepare() noexcept;
+    uint64_t slackTimeout(gint timeout) const noexcept;
     void dispatch() noexcept;
+    void pollReadyFds() noexcept;
+    void checkAndDispatchInstrumented() noexcept;
     void updatePollHandles() noexcept;
+    bool addPollRegistration(PollRegistration& registration) noexcept;
+    void removePollRegistration(const PollRegistration& registration) noexcept;
+    void rearmPollRegistration(const PollRegistration& registration) noexcept;
+    void revalidatePollRegistration(const PollRegistration& registration) noexcept;
+    void modifyEpollRegistration(const PollRegistration& registration) noexcept;
+    void harvestEpollEvents() noexcept;
 
     static void onPrepare(uv_prepare_t* handle);
     static void onCheck(uv_check_t* handle);
     static void onTimer(uv_timer_t* handle);
     static void onPoll(uv_poll_t* handle, int status, int events);
+    static void onEpollReadable(uv_poll_t* handle, int status, int events);
 
     static void onSimpleClose(uv_handle_t* handle);
     static void onPollClose(uv_handle_t* handle);
@@ -81,6 +200,7 @@ private:
 
     uv_loop_t* m_loop = nullptr;
     GMainContext* m_context = nullptr;
+    Options m_options;
 
     uv_prepare_t* m_prepare = nullptr;
     uv_check_t* m_check = nullptr;
@@ -96,6 +216,34 @@ private:
     gint m_pollFdsSize = 0;
     gint m_pollFdsCapacity = 0;
 
-    // fd -> uv_poll handle currently registered with the loop.
-    std::unordered_map<int, uv_poll_t*> m_pollHandles;
+    // Registrations currently live in the loop, sorted by fd. Each
+    // updatePollHandles() builds the wanted set in m_pollScratch, merges it
+    // against this array and swaps the two, so a steady fd set costs no
+    // allocations and no libuv calls.
+    std::vector<PollRegistration> m_pollRegistrations;
+    std::vector<PollRegistration> m_pollScratch;
+    // GLib's fd list as of the last updatePollHandles(), to tell when it
+    // changed.
+    std::vector<std::pair<int, gushort>> m_lastPollFds;
+    PollHandleStats m_pollHandleStats;
+    DispatchBudgetStats m_dispatchBudgetStats;
+    int64_t m_frameTimeUs = 0;
+    uint32_t m_frameIntervalUs = 0;
+    std::unique_ptr<MessagePumpStats> m_stats;
+    std::unique_ptr<StallWatchdog> m_watchdog;
+    // Wakeup classification for m_stats: whether a GLib fd fired during the
+    // last poll phase, and the uv_now() at which the armed GLib timeout
+    // expires (0 when none is armed, or it is zero).
+    bool m_fdWakeup = false;
+    uint64_t m_timerDeadline = 0;
+
+    // PollMode::Epoll only: the private epoll instance, the single uv_poll
+    // watching it, and reusable epoll_wait / harvest buffers.
+    int m_epollFd = -1;
+    uv_poll_t* m_epollHandle = nullptr;
+    bool m_epollReadable = false;
+    std::vector<struct epoll_event> m_epollEvents;
+    std::vector<std::pair<int, gushort>> m_readyFds;
+
+    std::unique_ptr<InvokeQueue> m_invokeQueue;
 };
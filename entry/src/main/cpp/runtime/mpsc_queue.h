@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Bounded lock-free multi-producer / single-consumer FIFO.
+ *
+ * Slots carry a sequence number (Vyukov's bounded queue): a producer claims a
+ * slot with a single CAS on the tail, constructs the element in place and then
+ * publishes it by bumping the slot sequence. The single consumer never needs a
+ * CAS; it only observes sequences. A full queue is reported to the producer
+ * (tryPush returns false) rather than blocking, since the consumer may well be
+ * the calling thread.
+ *
+ * The capacity must be a power of two. tryPush may be called from any thread,
+ * tryPop only from the consumer thread.
+ */
+template<typename T>
+class MPSCQueue final {
+public:
+    explicit MPSCQueue(size_t capacity)
+        : m_slots(new Slot[capacity])
+        , m_mask(capacity - 1)
+    {
+        for (size_t i = 0; i < capacity; ++i)
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MPSCQueue(MPSCQueue&&) = delete;
+    MPSCQueue& operator=(MPSCQueue&&) = delete;
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    ~MPSCQueue()
+    {
+        T discarded;
+        while (tryPop(discarded)) { }
+    }
+
+    bool tryPush(T&& value) noexcept
+    {
+        size_t position = m_tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[position & m_mask];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                return false; // Full: the consumer has not yet freed this slot.
+            } else {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (&slot->storage) T(std::move(value));
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& out) noexcept
+    {
+        Slot* slot = &m_slots[m_head & m_mask];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        // A claimed-but-unpublished slot reads as empty; its producer publishes
+        // and signals afterwards, so the element is picked up by a later pop.
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(m_head + 1) < 0)
+            return false;
+
+        T* element = std::launder(reinterpret_cast<T*>(&slot->storage));
+        out = std::move(*element);
+        element->~T();
+        slot->sequence.store(m_head + m_mask + 1, std::memory_order_release);
+        ++m_head;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    const size_t m_mask;
+
+    // Producers and the consumer live on different threads; keep their
+    // indices on separate cache lines.
+    alignas(64) std::atomic<size_t> m_tail { 0 };
+    alignas(64) size_t m_head = 0;
+};
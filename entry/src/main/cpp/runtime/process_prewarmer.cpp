@@ -0,0 +1,175 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "process_prewarmer.h"
+
+#include <glib.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <utility>
+
+#include "log.h"
+
+namespace {
+
+const char* ModeName(ProcessPrewarmer::Mode mode)
+{
+    switch (mode) {
+    case ProcessPrewarmer::Mode::None:
+        return "none";
+    case ProcessPrewarmer::Mode::Processes:
+        return "processes";
+    case ProcessPrewarmer::Mode::BlankPage:
+        return "blankPage";
+    }
+    return "none";
+}
+
+const char* PhaseName(ProcessPrewarmer::Phase phase)
+{
+    switch (phase) {
+    case ProcessPrewarmer::Phase::UIProcessReady:
+        return "uiProcessReadyMs";
+    case ProcessPrewarmer::Phase::NetworkProcessReady:
+        return "networkProcessReadyMs";
+    case ProcessPrewarmer::Phase::BlankPageLoaded:
+        return "blankPageLoadedMs";
+    case ProcessPrewarmer::Phase::FirstViewInit:
+        return "firstViewInitMs";
+    case ProcessPrewarmer::Phase::FirstLoadCommitted:
+        return "firstLoadCommittedMs";
+    case ProcessPrewarmer::Phase::Count:
+        break;
+    }
+    return "unknownMs";
+}
+
+} // namespace
+
+void ProcessPrewarmer::Start(Mode mode, WPEDisplay* display)
+{
+    mode_.store(mode, std::memory_order_relaxed);
+    if (mode == Mode::None)
+        return;
+
+    LOGD("ProcessPrewarmer::Start - mode: %{public}s", ModeName(mode));
+
+    // Taken over by the first web view created without a related view.
+    webkit_web_context_prewarm(webkit_web_context_get_default());
+
+    // The NetworkProcess is launched on the first request that needs it; a
+    // cookie fetch is the cheapest such request, and its reply tells when the
+    // process is up.
+    auto* manager = webkit_network_session_get_website_data_manager(webkit_network_session_get_default());
+    webkit_website_data_manager_fetch(manager, WEBKIT_WEBSITE_DATA_COOKIES, nullptr,
+        ProcessPrewarmer::OnNetworkDataFetched, this);
+
+    if (mode != Mode::BlankPage)
+        return;
+
+    blankView_ = WEBKIT_WEB_VIEW(g_object_new(WEBKIT_TYPE_WEB_VIEW, "display", display, nullptr));
+    if (blankView_ == nullptr) {
+        LOGE("ProcessPrewarmer::Start - failed to create the blank-page web view");
+        return;
+    }
+    blankLoadHandler_ = g_signal_connect(blankView_, "load-changed",
+        G_CALLBACK(ProcessPrewarmer::OnBlankLoadChanged), this);
+    webkit_web_view_load_uri(blankView_, "about:blank");
+}
+
+void ProcessPrewarmer::Stop()
+{
+    if (blankView_ == nullptr)
+        return;
+    DisconnectBlankView();
+    g_object_unref(blankView_);
+    blankView_ = nullptr;
+}
+
+WebKitWebView* ProcessPrewarmer::TakeWebView()
+{
+    if (blankView_ == nullptr)
+        return nullptr;
+
+    DisconnectBlankView();
+    adopted_.store(true, std::memory_order_relaxed);
+    return std::exchange(blankView_, nullptr);
+}
+
+void ProcessPrewarmer::Mark(Phase phase) noexcept
+{
+    const int64_t elapsed = g_get_monotonic_time() - originUs_.load(std::memory_order_relaxed);
+    int64_t unset = -1;
+    phaseUs_[static_cast<int>(phase)].compare_exchange_strong(unset, elapsed, std::memory_order_relaxed);
+}
+
+std::string ProcessPrewarmer::ToJson() const
+{
+    std::string json = "{\"mode\":\"";
+    json += ModeName(mode_.load(std::memory_order_relaxed));
+    json += '"';
+
+    char buffer[64];
+    for (int i = 0; i < static_cast<int>(Phase::Count); ++i) {
+        const int64_t us = phaseUs_[i].load(std::memory_order_relaxed);
+        if (us < 0)
+            snprintf(buffer, sizeof(buffer), ",\"%s\":null", PhaseName(static_cast<Phase>(i)));
+        else
+            snprintf(buffer, sizeof(buffer), ",\"%s\":%" PRId64 ".%03" PRId64, PhaseName(static_cast<Phase>(i)),
+                us / 1000, us % 1000);
+        json += buffer;
+    }
+
+    json += ",\"adopted\":";
+    json += adopted_.load(std::memory_order_relaxed) ? "true" : "false";
+    json += '}';
+    return json;
+}
+
+void ProcessPrewarmer::OnNetworkDataFetched(GObject* manager, GAsyncResult* result, gpointer userData)
+{
+    GError* error = nullptr;
+    GList* data = webkit_website_data_manager_fetch_finish(WEBKIT_WEBSITE_DATA_MANAGER(manager), result, &error);
+    if (error != nullptr) {
+        LOGE("ProcessPrewarmer - website data fetch failed: %{public}s", error->message);
+        g_error_free(error);
+        return;
+    }
+    g_list_free_full(data, reinterpret_cast<GDestroyNotify>(webkit_website_data_unref));
+
+    static_cast<ProcessPrewarmer*>(userData)->Mark(Phase::NetworkProcessReady);
+}
+
+void ProcessPrewarmer::OnBlankLoadChanged(WebKitWebView* /*webView*/, WebKitLoadEvent loadEvent, gpointer userData)
+{
+    if (loadEvent != WEBKIT_LOAD_FINISHED)
+        return;
+
+    auto* prewarmer = static_cast<ProcessPrewarmer*>(userData);
+    prewarmer->Mark(Phase::BlankPageLoaded);
+    prewarmer->DisconnectBlankView();
+}
+
+void ProcessPrewarmer::DisconnectBlankView()
+{
+    if (blankLoadHandler_ == 0)
+        return;
+    g_signal_handler_disconnect(blankView_, blankLoadHandler_);
+    blankLoadHandler_ = 0;
+}
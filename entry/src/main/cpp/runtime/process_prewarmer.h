@@ -0,0 +1,105 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <wpe/webkit.h>
+
+/*
+ * ProcessPrewarmer starts WebKit's auxiliary processes as soon as the UI
+ * process is up, instead of on the first view's first load:
+ *
+ *  - Processes: webkit_web_context_prewarm() launches a WebProcess that the
+ *    first web view takes over, and a website data fetch makes the network
+ *    session launch the NetworkProcess.
+ *  - BlankPage: additionally loads about:blank in a web view of its own, which
+ *    also initializes the WebProcess's page. The first WKWebView::Init()
+ *    adopts that view, so its first navigation runs in that process.
+ *
+ * It also keeps cold start phase times (milliseconds since
+ * WKRuntime::Initialize) whatever the mode, so runs with and without
+ * prewarming compare directly. Everything but Mark() and ToJson() runs on
+ * WebKit's thread.
+ */
+class ProcessPrewarmer final {
+public:
+    enum class Mode {
+        None,
+        Processes,
+        BlankPage,
+    };
+
+    enum class Phase {
+        UIProcessReady,
+        NetworkProcessReady,
+        BlankPageLoaded,
+        FirstViewInit,
+        FirstLoadCommitted,
+        Count,
+    };
+
+    ProcessPrewarmer()
+    {
+        for (auto& phase : phaseUs_)
+            phase.store(-1, std::memory_order_relaxed);
+    }
+
+    ProcessPrewarmer(ProcessPrewarmer&&) = delete;
+    ProcessPrewarmer& operator=(ProcessPrewarmer&&) = delete;
+    ProcessPrewarmer(const ProcessPrewarmer&) = delete;
+    ProcessPrewarmer& operator=(const ProcessPrewarmer&) = delete;
+
+    ~ProcessPrewarmer() = default;
+
+    // Phase times are relative to this call (g_get_monotonic_time).
+    void SetOrigin(int64_t timeUs) noexcept { originUs_.store(timeUs, std::memory_order_relaxed); }
+
+    void Start(Mode mode, WPEDisplay* display);
+
+    // Releases a blank-page view nobody adopted.
+    void Stop();
+
+    // The blank-page view (transfer full), loaded or still loading; null
+    // otherwise. Once only.
+    WebKitWebView* TakeWebView();
+
+    // Any thread; only the first mark of each phase counts.
+    void Mark(Phase phase) noexcept;
+
+    // {"mode":"...","uiProcessReadyMs":N,...,"adopted":bool}; phases not
+    // reached yet are null.
+    std::string ToJson() const;
+
+private:
+    static void OnNetworkDataFetched(GObject* manager, GAsyncResult* result, gpointer userData);
+    static void OnBlankLoadChanged(WebKitWebView* webView, WebKitLoadEvent loadEvent, gpointer userData);
+
+    void DisconnectBlankView();
+
+    std::atomic<int64_t> originUs_ { 0 };
+    std::atomic<int64_t> phaseUs_[static_cast<int>(Phase::Count)];
+    std::atomic<Mode> mode_ { Mode::None };
+    std::atomic<bool> adopted_ { false };
+
+    WebKitWebView* blankView_ = nullptr;
+    gulong blankLoadHandler_ = 0;
+};
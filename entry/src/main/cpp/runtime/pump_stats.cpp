@@ -0,0 +1,223 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "pump_stats.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+// The stats of the pump currently inside g_main_context_dispatch on this
+// thread, if it is instrumented.
+thread_local MessagePumpStats* t_dispatchingStats = nullptr;
+
+void appendHistogram(std::string& out, const char* key, const LogLinearHistogram& histogram)
+{
+    char buffer[256];
+    std::snprintf(buffer, sizeof(buffer),
+        "\"%s\":{\"count\":%llu,\"sum\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"max\":%llu}",
+        key,
+        static_cast<unsigned long long>(histogram.count()),
+        static_cast<unsigned long long>(histogram.sum()),
+        static_cast<unsigned long long>(histogram.percentile(50)),
+        static_cast<unsigned long long>(histogram.percentile(90)),
+        static_cast<unsigned long long>(histogram.percentile(99)),
+        static_cast<unsigned long long>(histogram.max()));
+    out += buffer;
+}
+
+void appendJsonString(std::string& out, const char* value)
+{
+    out += '"';
+    for (const char* c = value; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+            out += *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            out += ' ';
+        } else {
+            out += *c;
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+unsigned LogLinearHistogram::bucketFor(uint64_t value) noexcept
+{
+    if (value < kSubBuckets)
+        return static_cast<unsigned>(value);
+    const unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(value));
+    const unsigned subBucket = static_cast<unsigned>(value >> (exponent - 2)) & (kSubBuckets - 1);
+    return kSubBuckets + (exponent - 2) * kSubBuckets + subBucket;
+}
+
+uint64_t LogLinearHistogram::bucketUpperBound(unsigned bucket) noexcept
+{
+    if (bucket < kSubBuckets)
+        return bucket;
+    const unsigned exponent = (bucket - kSubBuckets) / kSubBuckets + 2;
+    const uint64_t subBucket = (bucket - kSubBuckets) % kSubBuckets;
+    const uint64_t lower = (kSubBuckets + subBucket) << (exponent - 2);
+    return lower + ((uint64_t(1) << (exponent - 2)) - 1);
+}
+
+void LogLinearHistogram::record(uint64_t value) noexcept
+{
+    ++m_buckets[bucketFor(value)];
+    ++m_count;
+    m_sum += value;
+    if (value > m_max)
+        m_max = value;
+}
+
+void LogLinearHistogram::reset() noexcept
+{
+    *this = LogLinearHistogram();
+}
+
+uint64_t LogLinearHistogram::percentile(double percent) const noexcept
+{
+    if (m_count == 0)
+        return 0;
+    auto rank = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(m_count) + 0.5);
+    if (rank == 0)
+        rank = 1;
+    uint64_t seen = 0;
+    for (unsigned bucket = 0; bucket < kBucketCount; ++bucket) {
+        seen += m_buckets[bucket];
+        if (seen >= rank)
+            return bucketUpperBound(bucket) < m_max ? bucketUpperBound(bucket) : m_max;
+    }
+    return m_max;
+}
+
+uint64_t MessagePumpStats::now() noexcept
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+MessagePumpStats::SourceScope::SourceScope(GSource* source) noexcept
+    : m_stats(t_dispatchingStats)
+{
+    if (m_stats == nullptr)
+        return;
+    // Only the outermost scope books time, so nested scopes never count twice.
+    m_outermost = m_stats->m_scopeDepth++ == 0;
+    if (!m_outermost)
+        return;
+    m_name = source != nullptr ? g_source_get_name(source) : nullptr;
+    m_start = now();
+}
+
+MessagePumpStats::SourceScope::~SourceScope()
+{
+    if (m_stats == nullptr)
+        return;
+    --m_stats->m_scopeDepth;
+    if (!m_outermost)
+        return;
+    const uint64_t duration = now() - m_start;
+    m_stats->m_attributed += duration;
+    m_stats->recordSource(m_name != nullptr ? m_name : kUnattributedSource, duration);
+}
+
+void MessagePumpStats::beginDispatch() noexcept
+{
+    m_dispatchStart = now();
+    m_attributed = 0;
+    m_scopeDepth = 0;
+    t_dispatchingStats = this;
+}
+
+void MessagePumpStats::endDispatch() noexcept
+{
+    t_dispatchingStats = nullptr;
+    const uint64_t total = now() - m_dispatchStart;
+    dispatch.record(total);
+    if (total > m_attributed)
+        recordSource(kUnattributedSource, total - m_attributed);
+}
+
+MessagePumpStats::SourceEntry* MessagePumpStats::entryFor(const char* name) noexcept
+{
+    for (unsigned i = 0; i < m_sourceCount; ++i) {
+        if (std::strncmp(m_sources[i].name, name, sizeof(m_sources[i].name) - 1) == 0)
+            return &m_sources[i];
+    }
+    // The table is fixed; the last slot collects everything that did not fit.
+    if (m_sourceCount == kMaxSources - 1) {
+        SourceEntry& other = m_sources[kMaxSources - 1];
+        if (other.name[0] == '\0')
+            std::strncpy(other.name, kOtherSources, sizeof(other.name) - 1);
+        return &other;
+    }
+    SourceEntry& entry = m_sources[m_sourceCount++];
+    std::strncpy(entry.name, name, sizeof(entry.name) - 1);
+    return &entry;
+}
+
+void MessagePumpStats::recordSource(const char* name, uint64_t duration) noexcept
+{
+    entryFor(name)->duration.record(duration);
+}
+
+std::string MessagePumpStats::toJson() const
+{
+    std::string out;
+    out.reserve(2048);
+
+    char buffer[192];
+    std::snprintf(buffer, sizeof(buffer),
+        "{\"unit\":\"ns\",\"iterations\":%llu,\"wakeups\":{\"fd\":%llu,\"timer\":%llu},\"invocations\":%llu,",
+        static_cast<unsigned long long>(iterations),
+        static_cast<unsigned long long>(fdWakeups),
+        static_cast<unsigned long long>(timerWakeups),
+        static_cast<unsigned long long>(invocations));
+    out += buffer;
+
+    out += "\"phases\":{";
+    appendHistogram(out, "prepare", prepare);
+    out += ',';
+    appendHistogram(out, "query", query);
+    out += ',';
+    appendHistogram(out, "check", check);
+    out += ',';
+    appendHistogram(out, "dispatch", dispatch);
+    out += "},";
+    appendHistogram(out, "pollFds", pollFds);
+
+    out += ",\"sources\":[";
+    const unsigned count = m_sources[kMaxSources - 1].name[0] != '\0' ? kMaxSources : m_sourceCount;
+    for (unsigned i = 0; i < count; ++i) {
+        if (i > 0)
+            out += ',';
+        out += "{\"name\":";
+        appendJsonString(out, m_sources[i].name);
+        out += ',';
+        appendHistogram(out, "duration", m_sources[i].duration);
+        out += '}';
+    }
+    out += "]}";
+    return out;
+}
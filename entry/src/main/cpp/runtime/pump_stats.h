@@ -0,0 +1,143 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include <cstdint>
+#include <string>
+
+/*
+ * Fixed-size log-linear histogram: values below 4 get a bucket each, above
+ * that every power of two is split into 4 linear sub-buckets (<= 25% relative
+ * error). Covers the full uint64_t range in 252 buckets, never allocates.
+ */
+class LogLinearHistogram final {
+public:
+    static constexpr unsigned kSubBuckets = 4;
+    static constexpr unsigned kBucketCount = kSubBuckets + (64 - 2) * kSubBuckets;
+
+    void record(uint64_t value) noexcept;
+    void reset() noexcept;
+
+    uint64_t count() const noexcept { return m_count; }
+    uint64_t sum() const noexcept { return m_sum; }
+    uint64_t max() const noexcept { return m_max; }
+
+    // Upper bound of the bucket holding the given percentile (0..100).
+    uint64_t percentile(double percent) const noexcept;
+
+private:
+    static unsigned bucketFor(uint64_t value) noexcept;
+    static uint64_t bucketUpperBound(unsigned bucket) noexcept;
+
+    uint32_t m_buckets[kBucketCount] = {};
+    uint64_t m_count = 0;
+    uint64_t m_sum = 0;
+    uint64_t m_max = 0;
+};
+
+/*
+ * Opt-in MessagePump instrumentation. The pump only touches this through a
+ * pointer that is null while stats are disabled, so the disabled cost is one
+ * branch per measurement point. All durations are in nanoseconds.
+ *
+ * Per-source attribution: GLib has no public hook around the dispatch of an
+ * individual source, so time is attributed by the sources themselves via
+ * SourceScope (the pump's invoke queue, the WPE frame source, ...). Whatever
+ * part of a g_main_context_dispatch no scope claimed is recorded under
+ * kUnattributedSource.
+ *
+ * Must only be used on the pump's thread.
+ */
+class MessagePumpStats final {
+public:
+    static constexpr unsigned kMaxSources = 16;
+    static constexpr const char* kUnattributedSource = "(unattributed)";
+    static constexpr const char* kOtherSources = "(other)";
+
+    static uint64_t now() noexcept;
+
+    // Attributes the enclosed time to `source` (by g_source_get_name) when
+    // the current thread is dispatching an instrumented pump.
+    class SourceScope final {
+    public:
+        explicit SourceScope(GSource* source) noexcept;
+        ~SourceScope();
+
+        SourceScope(const SourceScope&) = delete;
+        SourceScope& operator=(const SourceScope&) = delete;
+
+    private:
+        MessagePumpStats* m_stats;
+        const char* m_name = nullptr;
+        uint64_t m_start = 0;
+        bool m_outermost = false;
+    };
+
+    // Brackets one g_main_context_dispatch; makes SourceScope live on this
+    // thread and books the unclaimed remainder as unattributed.
+    void beginDispatch() noexcept;
+    void endDispatch() noexcept;
+
+    void recordSource(const char* name, uint64_t duration) noexcept;
+
+    // Classifies what ended the poll wait before a check phase: a ready GLib
+    // fd, else the armed GLib timeout having expired. A check phase reached
+    // any other way (invoke()'s loop wakeup, a dispatch budget yield) is
+    // neither, so the two counters only count real wakeups.
+    void recordWakeup(bool fdReady, bool timerExpired) noexcept
+    {
+        if (fdReady)
+            ++fdWakeups;
+        else if (timerExpired)
+            ++timerWakeups;
+    }
+
+    // Compact JSON: phase and fd-count summaries, wakeup counters and the
+    // per-source table.
+    std::string toJson() const;
+
+    LogLinearHistogram prepare;
+    LogLinearHistogram query;
+    LogLinearHistogram check;
+    LogLinearHistogram dispatch;
+    LogLinearHistogram pollFds;
+
+    uint64_t iterations = 0;
+    // Check phases, not fd callbacks or timer callbacks; see recordWakeup().
+    uint64_t fdWakeups = 0;
+    uint64_t timerWakeups = 0;
+    uint64_t invocations = 0;
+
+private:
+    struct SourceEntry {
+        char name[48] = {};
+        LogLinearHistogram duration;
+    };
+
+    SourceEntry* entryFor(const char* name) noexcept;
+
+    SourceEntry m_sources[kMaxSources];
+    unsigned m_sourceCount = 0;
+
+    uint64_t m_dispatchStart = 0;
+    uint64_t m_attributed = 0;
+    int m_scopeDepth = 0;
+};
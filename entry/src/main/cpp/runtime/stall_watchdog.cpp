@@ -0,0 +1,468 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "stall_watchdog.h"
+
+#include <dlfcn.h>
+#include <glib.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "log.h"
+
+namespace {
+
+constexpr unsigned kCaptureFrames = 48;
+
+// How long the watchdog waits for the stalled thread to run the capture
+// handler. A thread blocked with the signal masked never does.
+constexpr auto kCaptureTimeout = std::chrono::milliseconds(200);
+
+// OHOS reserves the low real-time signals (faultloggerd dumps on 35 etc.), so
+// take one from the top of the range.
+int captureSignal()
+{
+    return SIGRTMAX - 3;
+}
+
+// Filled in by the signal handler on the stalled thread. One capture is in
+// flight at a time, owned by whoever moved `state` from Idle to Preparing; the
+// handler only acts once it is Requested, i.e. once the stack bounds are set.
+struct CaptureSlot {
+    enum : int { Idle, Preparing, Requested, Done };
+    std::atomic<int> state { Idle };
+    uintptr_t stackLow = 0;
+    uintptr_t stackHigh = 0;
+    uintptr_t frames[kCaptureFrames] = {};
+    unsigned frameCount = 0;
+    bool hasSource = false;
+    int priority = 0;
+    char source[64] = {};
+};
+
+CaptureSlot s_capture;
+
+// Walks the frame-pointer chain of the interrupted code: every frame record
+// is {caller's frame pointer, return address}, at the frame pointer, on both
+// AArch64 and x86-64. Unlike _Unwind_Backtrace, which takes the loader's
+// locks to find unwind tables and can deadlock if the thread was stopped
+// holding them, this only reads the stack, and only its live part: between
+// the stack pointer and the thread's stack top. The walk ends at the first
+// frame built without a frame pointer.
+unsigned walkFramePointers(const ucontext_t* context, uintptr_t stackLow, uintptr_t stackHigh, uintptr_t* frames)
+{
+#if defined(__aarch64__)
+    const auto pc = static_cast<uintptr_t>(context->uc_mcontext.pc);
+    const auto sp = static_cast<uintptr_t>(context->uc_mcontext.sp);
+    auto fp = static_cast<uintptr_t>(context->uc_mcontext.regs[29]);
+#elif defined(__x86_64__)
+    const auto pc = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RIP]);
+    const auto sp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RSP]);
+    auto fp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RBP]);
+#else
+    (void)context;
+    const uintptr_t pc = 0;
+    const uintptr_t sp = 0;
+    uintptr_t fp = 0;
+#endif
+    unsigned count = 0;
+    if (pc == 0)
+        return count;
+    frames[count++] = pc;
+
+    // Frames only move up the stack; anything else is not a frame record.
+    const uintptr_t low = std::max(sp, stackLow);
+    while (count < kCaptureFrames && fp >= low && fp + 2 * sizeof(uintptr_t) <= stackHigh
+        && fp % sizeof(uintptr_t) == 0) {
+        const auto* record = reinterpret_cast<const uintptr_t*>(fp);
+        const uintptr_t next = record[0];
+        const uintptr_t returnAddress = record[1];
+        if (returnAddress == 0)
+            break;
+        frames[count++] = returnAddress;
+        if (next <= fp)
+            break;
+        fp = next;
+    }
+    return count;
+}
+
+// Runs on the stalled thread, inside whatever it was dispatching. Only reads:
+// the stack walk touches nothing but the stack, g_main_current_source() is a
+// thread-local lookup and the source name and priority are plain fields, so
+// nothing here takes a lock.
+void onCaptureSignal(int, siginfo_t*, void* context)
+{
+    const int savedErrno = errno;
+    if (s_capture.state.load(std::memory_order_acquire) == CaptureSlot::Requested) {
+        s_capture.frameCount = walkFramePointers(static_cast<const ucontext_t*>(context), s_capture.stackLow,
+            s_capture.stackHigh, s_capture.frames);
+
+        GSource* source = g_main_current_source();
+        s_capture.hasSource = source != nullptr;
+        s_capture.priority = source ? g_source_get_priority(source) : 0;
+        const char* name = source ? g_source_get_name(source) : nullptr;
+        size_t length = 0;
+        if (name != nullptr) {
+            while (name[length] != '\0' && length < sizeof(s_capture.source) - 1) {
+                s_capture.source[length] = name[length];
+                ++length;
+            }
+        }
+        s_capture.source[length] = '\0';
+
+        s_capture.state.store(CaptureSlot::Done, std::memory_order_release);
+    }
+    errno = savedErrno;
+}
+
+void installCaptureHandler()
+{
+    static std::once_flag s_once;
+    std::call_once(s_once, [] {
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = onCaptureSignal;
+        action.sa_flags = SA_SIGINFO | SA_RESTART | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(captureSignal(), &action, nullptr) != 0)
+            LOGE("StallWatchdog: sigaction failed: %{public}s", std::strerror(errno));
+    });
+}
+
+uint64_t wallTimeMs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+void appendJsonString(std::string& out, const char* value)
+{
+    out += '"';
+    for (const char* c = value; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+            out += *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(*c));
+            out += escaped;
+        } else {
+            out += *c;
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+StallWatchdog::StallWatchdog(const Options& options)
+    : m_thresholdNs(static_cast<uint64_t>(options.thresholdMs) * 1000000)
+    , m_dumpDirectory(options.dumpDirectory)
+    , m_target(pthread_self())
+{
+    installCaptureHandler();
+    pthread_attr_t attributes;
+    if (pthread_getattr_np(m_target, &attributes) == 0) {
+        void* stackAddress = nullptr;
+        size_t stackSize = 0;
+        if (pthread_attr_getstack(&attributes, &stackAddress, &stackSize) == 0) {
+            m_stackLow = reinterpret_cast<uintptr_t>(stackAddress);
+            m_stackHigh = m_stackLow + stackSize;
+        }
+        pthread_attr_destroy(&attributes);
+    }
+    if (m_stackHigh == 0)
+        LOGE("StallWatchdog: unknown stack bounds, reports will show the stalled pc only");
+    if (!m_dumpDirectory.empty() && mkdir(m_dumpDirectory.c_str(), 0700) != 0 && errno != EEXIST)
+        LOGE("StallWatchdog: cannot create %{public}s: %{public}s", m_dumpDirectory.c_str(), std::strerror(errno));
+
+    m_thread = std::thread([this] { run(); });
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stopMutex);
+        m_stop = true;
+    }
+    m_stopCondition.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+uint64_t StallWatchdog::now() noexcept
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void StallWatchdog::run()
+{
+    pthread_setname_np(pthread_self(), "WebKitWatchdog");
+
+    // Checking four times per threshold catches a stall at 1.0-1.25x the
+    // threshold.
+    const auto period = std::chrono::nanoseconds(std::max<uint64_t>(m_thresholdNs / 4, 10000000));
+    std::unique_lock<std::mutex> lock(m_stopMutex);
+    while (!m_stopCondition.wait_for(lock, period, [this] { return m_stop; })) {
+        lock.unlock();
+        check();
+        lock.lock();
+    }
+}
+
+void StallWatchdog::check()
+{
+    const uint64_t lastStallSequence = m_lastStallSequence.load(std::memory_order_acquire);
+    const uint64_t lastStallDuration = m_lastStallDuration.load(std::memory_order_relaxed);
+
+    // Close the report of a stall seen in progress.
+    if (m_openSequence != 0) {
+        const uint64_t start = m_dispatchStart.load(std::memory_order_acquire);
+        const bool running = start != 0 && m_sequence.load(std::memory_order_relaxed) == m_openSequence;
+        Report finished;
+        {
+            std::lock_guard<std::mutex> lock(m_reportsMutex);
+            Report* report = findReport(m_openSequence);
+            if (report != nullptr && running) {
+                report->durationNs = now() - start;
+            } else if (report != nullptr) {
+                // A later stall may have overwritten the duration; keep the
+                // last one seen then.
+                if (lastStallSequence == m_openSequence)
+                    report->durationNs = lastStallDuration;
+                report->finished = true;
+                finished = *report;
+            }
+        }
+        if (!running) {
+            m_openSequence = 0;
+            if (finished.finished)
+                writeDump(finished, false);
+        }
+    }
+
+    // A stall that started and ended between two checks.
+    if (lastStallSequence > m_reportedSequence) {
+        m_reportedSequence = lastStallSequence;
+        Report report;
+        report.sequence = lastStallSequence;
+        report.time = wallTimeMs();
+        report.durationNs = lastStallDuration;
+        report.finished = true;
+        {
+            std::lock_guard<std::mutex> lock(m_reportsMutex);
+            addReport() = report;
+        }
+        writeDump(report, true);
+    }
+
+    // A stall in progress: capture where the thread is.
+    const uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+    const uint64_t start = m_dispatchStart.load(std::memory_order_acquire);
+    if (start == 0 || sequence <= m_reportedSequence || now() - start < m_thresholdNs)
+        return;
+
+    m_reportedSequence = sequence;
+    m_openSequence = sequence;
+    Report report;
+    report.sequence = sequence;
+    report.time = wallTimeMs();
+    report.durationNs = now() - start;
+    report.captured = capture(sequence, report);
+    LOGE("StallWatchdog: dispatch running for %{public}llu ms in '%{public}s'",
+        static_cast<unsigned long long>(report.durationNs / 1000000), report.source[0] ? report.source : "?");
+    {
+        std::lock_guard<std::mutex> lock(m_reportsMutex);
+        addReport() = report;
+    }
+    writeDump(report, true);
+}
+
+bool StallWatchdog::capture(uint64_t sequence, Report& report)
+{
+    // A capture whose handler ran after we gave up on it.
+    int expected = CaptureSlot::Done;
+    s_capture.state.compare_exchange_strong(expected, CaptureSlot::Idle, std::memory_order_acq_rel);
+
+    expected = CaptureSlot::Idle;
+    if (!s_capture.state.compare_exchange_strong(expected, CaptureSlot::Preparing, std::memory_order_acq_rel))
+        return false;
+    s_capture.stackLow = m_stackLow;
+    s_capture.stackHigh = m_stackHigh;
+    s_capture.state.store(CaptureSlot::Requested, std::memory_order_release);
+
+    if (pthread_kill(m_target, captureSignal()) != 0) {
+        s_capture.state.store(CaptureSlot::Idle, std::memory_order_release);
+        return false;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + kCaptureTimeout;
+    while (s_capture.state.load(std::memory_order_acquire) != CaptureSlot::Done) {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // The dispatch may have ended while the signal was in flight, in which
+    // case the capture shows some unrelated point.
+    const bool valid = m_sequence.load(std::memory_order_relaxed) == sequence
+        && m_dispatchStart.load(std::memory_order_acquire) != 0;
+    if (valid) {
+        report.frameCount = std::min(s_capture.frameCount, kMaxFrames);
+        std::copy(s_capture.frames, s_capture.frames + report.frameCount, report.frames);
+        report.priority = s_capture.priority;
+        if (s_capture.hasSource)
+            std::snprintf(report.source, sizeof(report.source), "%s", s_capture.source[0] ? s_capture.source : "(unnamed)");
+    }
+    s_capture.state.store(CaptureSlot::Idle, std::memory_order_release);
+    return valid;
+}
+
+StallWatchdog::Report& StallWatchdog::addReport()
+{
+    Report& report = m_reports[m_nextReport];
+    m_nextReport = (m_nextReport + 1) % kMaxReports;
+    m_reportCount = std::min(m_reportCount + 1, kMaxReports);
+    report = Report();
+    return report;
+}
+
+StallWatchdog::Report* StallWatchdog::findReport(uint64_t sequence)
+{
+    for (unsigned i = 0; i < m_reportCount; ++i) {
+        if (m_reports[i].sequence == sequence)
+            return &m_reports[i];
+    }
+    return nullptr;
+}
+
+void StallWatchdog::appendBacktrace(std::string& out, const Report& report, bool json)
+{
+    char line[512];
+    for (unsigned i = 0; i < report.frameCount; ++i) {
+        const uintptr_t pc = report.frames[i];
+        Dl_info info;
+        std::memset(&info, 0, sizeof(info));
+        int length;
+        if (dladdr(reinterpret_cast<void*>(pc), &info) != 0 && info.dli_fname != nullptr) {
+            const uintptr_t offset = pc - reinterpret_cast<uintptr_t>(info.dli_fbase);
+            if (info.dli_sname != nullptr) {
+                length = std::snprintf(line, sizeof(line), "#%02u pc %016" PRIxPTR " %s(%s+%" PRIuPTR ")", i, offset,
+                    info.dli_fname, info.dli_sname, pc - reinterpret_cast<uintptr_t>(info.dli_saddr));
+            } else {
+                length = std::snprintf(line, sizeof(line), "#%02u pc %016" PRIxPTR " %s", i, offset, info.dli_fname);
+            }
+        } else {
+            length = std::snprintf(line, sizeof(line), "#%02u pc %016" PRIxPTR " [unknown]", i, pc);
+        }
+        if (length < 0)
+            continue;
+
+        if (json) {
+            if (i > 0)
+                out += ',';
+            appendJsonString(out, line);
+        } else {
+            out += line;
+            out += '\n';
+        }
+    }
+}
+
+void StallWatchdog::writeDump(const Report& report, bool created)
+{
+    if (m_dumpDirectory.empty())
+        return;
+
+    char path[64];
+    std::snprintf(path, sizeof(path), "/webkitview-stall-%" PRIu64 "-%" PRIu64 ".log", report.time, report.sequence);
+    const std::string fullPath = m_dumpDirectory + path;
+    FILE* file = std::fopen(fullPath.c_str(), created ? "w" : "a");
+    if (file == nullptr) {
+        LOGE("StallWatchdog: cannot write %{public}s: %{public}s", fullPath.c_str(), std::strerror(errno));
+        return;
+    }
+
+    if (!created) {
+        std::fprintf(file, "Finished after: %" PRIu64 " ms\n", report.durationNs / 1000000);
+        std::fclose(file);
+        return;
+    }
+
+    std::string text;
+    char line[160];
+    std::snprintf(line, sizeof(line), "WebKitView main-thread stall\nTimestamp:%" PRIu64 "\nThreshold: %" PRIu64 " ms\n",
+        report.time, m_thresholdNs / 1000000);
+    text += line;
+    std::snprintf(line, sizeof(line), "%s: %" PRIu64 " ms\n", report.finished ? "Finished after" : "Running for",
+        report.durationNs / 1000000);
+    text += line;
+    if (report.captured) {
+        std::snprintf(line, sizeof(line), "Source: %s (priority %d)\nFault thread info:\n",
+            report.source[0] ? report.source : "(none)", report.priority);
+        text += line;
+        appendBacktrace(text, report, false);
+    } else {
+        text += "Source: unknown (ended before it could be captured)\n";
+    }
+    std::fputs(text.c_str(), file);
+    std::fclose(file);
+}
+
+std::string StallWatchdog::toJson() const
+{
+    std::string out;
+    char buffer[160];
+    std::snprintf(buffer, sizeof(buffer), "{\"thresholdMs\":%" PRIu64 ",\"stalls\":[", m_thresholdNs / 1000000);
+    out += buffer;
+
+    std::lock_guard<std::mutex> lock(m_reportsMutex);
+    const unsigned first = m_reportCount < kMaxReports ? 0 : m_nextReport;
+    for (unsigned n = 0; n < m_reportCount; ++n) {
+        const Report& report = m_reports[(first + n) % kMaxReports];
+        if (n > 0)
+            out += ',';
+        std::snprintf(buffer, sizeof(buffer), "{\"time\":%" PRIu64 ",\"durationMs\":%.1f,\"finished\":%s,\"captured\":%s,",
+            report.time, static_cast<double>(report.durationNs) / 1e6, report.finished ? "true" : "false",
+            report.captured ? "true" : "false");
+        out += buffer;
+        out += "\"source\":";
+        if (report.source[0] != '\0')
+            appendJsonString(out, report.source);
+        else
+            out += "null";
+        std::snprintf(buffer, sizeof(buffer), ",\"priority\":%d,\"backtrace\":[", report.priority);
+        out += buffer;
+        appendBacktrace(out, report, true);
+        out += "]}";
+    }
+    out += "]}";
+    return out;
+}
@@ -0,0 +1,144 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/*
+ * StallWatchdog watches MessagePump::dispatch() from a thread of its own and
+ * reports dispatches that run longer than a threshold, i.e. the moments where
+ * GLib (WebKit) work is what keeps the pump's thread from getting back to its
+ * event loop.
+ *
+ * The pump brackets every dispatch with dispatchStarted()/dispatchFinished(),
+ * which only store a timestamp and a sequence number. When the watchdog finds
+ * a dispatch past the threshold it signals the pump's thread; the handler
+ * records the GSource being dispatched (g_main_current_source) and a
+ * backtrace of the stalled thread, walked along its frame pointers (code
+ * built without them ends the backtrace early). Reports go into a small ring, readable as
+ * JSON, and are written to a dump directory as they happen, so a freeze that
+ * ends in the app being killed still leaves a file behind.
+ *
+ * Backtrace lines use the faultlogger frame format ("#00 pc <offset> <path>"),
+ * so tools/symbolize-faultlog.sh can symbolize a fetched dump.
+ */
+class StallWatchdog final {
+public:
+    struct Options {
+        // Dispatches running at least this long are reported.
+        uint32_t thresholdMs = 500;
+        // Where each report is written, as
+        // webkitview-stall-<time>-<sequence>.log; empty keeps reports in
+        // memory only.
+        std::string dumpDirectory;
+    };
+
+    // Watches dispatches made on the calling thread.
+    explicit StallWatchdog(const Options& options);
+
+    StallWatchdog(StallWatchdog&&) = delete;
+    StallWatchdog& operator=(StallWatchdog&&) = delete;
+    StallWatchdog(const StallWatchdog&) = delete;
+    StallWatchdog& operator=(const StallWatchdog&) = delete;
+
+    ~StallWatchdog();
+
+    // Heartbeat; watched thread only.
+    void dispatchStarted() noexcept
+    {
+        m_sequence.store(m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_dispatchStart.store(now(), std::memory_order_release);
+    }
+
+    void dispatchFinished() noexcept
+    {
+        const uint64_t duration = now() - m_dispatchStart.load(std::memory_order_relaxed);
+        m_dispatchStart.store(0, std::memory_order_release);
+        if (duration >= m_thresholdNs) {
+            m_lastStallDuration.store(duration, std::memory_order_relaxed);
+            m_lastStallSequence.store(m_sequence.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+    }
+
+    // Compact JSON: {"thresholdMs":N,"stalls":[...]}, oldest report first.
+    std::string toJson() const;
+
+    static uint64_t now() noexcept;
+
+private:
+    static constexpr unsigned kMaxReports = 16;
+    static constexpr unsigned kMaxFrames = 48;
+
+    struct Report {
+        uint64_t sequence = 0;
+        // Wall clock (ms since the epoch) of detection.
+        uint64_t time = 0;
+        // Until `finished`, the time the dispatch had been running when last
+        // checked.
+        uint64_t durationNs = 0;
+        bool finished = false;
+        // Stalls that ended between two watchdog checks have no capture.
+        bool captured = false;
+        int priority = 0;
+        char source[64] = {};
+        uintptr_t frames[kMaxFrames] = {};
+        unsigned frameCount = 0;
+    };
+
+    void run();
+    void check();
+    bool capture(uint64_t sequence, Report& report);
+    Report& addReport();
+    Report* findReport(uint64_t sequence);
+    void writeDump(const Report& report, bool created);
+    static void appendBacktrace(std::string& out, const Report& report, bool json);
+
+    const uint64_t m_thresholdNs;
+    const std::string m_dumpDirectory;
+    const pthread_t m_target;
+    // The watched thread's stack; the handler's walk stays inside it.
+    uintptr_t m_stackLow = 0;
+    uintptr_t m_stackHigh = 0;
+
+    std::atomic<uint64_t> m_sequence { 0 };
+    std::atomic<uint64_t> m_dispatchStart { 0 };
+    std::atomic<uint64_t> m_lastStallSequence { 0 };
+    std::atomic<uint64_t> m_lastStallDuration { 0 };
+
+    // Watchdog thread only.
+    uint64_t m_reportedSequence = 0;
+    uint64_t m_openSequence = 0;
+
+    mutable std::mutex m_reportsMutex;
+    Report m_reports[kMaxReports];
+    unsigned m_reportCount = 0;
+    unsigned m_nextReport = 0;
+
+    std::mutex m_stopMutex;
+    std::condition_variable m_stopCondition;
+    bool m_stop = false;
+    std::thread m_thread;
+};
@@ -0,0 +1,164 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "startup_trace.h"
+
+#if defined(WEBKITVIEW_STARTUP_TRACE) && WEBKITVIEW_STARTUP_TRACE
+
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace {
+
+struct TraceEvent {
+    // Index + 1 of the event in the slot, 0 while it is being written.
+    std::atomic<uint64_t> sequence { 0 };
+    const char* name = nullptr;
+    uint64_t timeNs = 0;
+    uint32_t tid = 0;
+    char phase = 0;
+};
+
+TraceEvent s_events[StartupTrace::kCapacity];
+std::atomic<uint64_t> s_next { 0 };
+
+uint32_t currentTid() noexcept
+{
+    static thread_local uint32_t s_tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    return s_tid;
+}
+
+void record(const char* name, char phase) noexcept
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    const uint64_t index = s_next.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& event = s_events[index % StartupTrace::kCapacity];
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name = name;
+    event.timeNs = static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    event.tid = currentTid();
+    event.phase = phase;
+    event.sequence.store(index + 1, std::memory_order_release);
+}
+
+void appendJsonString(std::string& out, const char* value)
+{
+    out += '"';
+    for (const char* c = value; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\')
+            out += '\\';
+        out += *c;
+    }
+    out += '"';
+}
+
+} // namespace
+
+void StartupTrace::begin(const char* name) noexcept
+{
+    record(name, 'B');
+}
+
+void StartupTrace::end(const char* name) noexcept
+{
+    record(name, 'E');
+}
+
+void StartupTrace::instant(const char* name) noexcept
+{
+    record(name, 'i');
+}
+
+std::string StartupTrace::toJson()
+{
+    const uint64_t next = s_next.load(std::memory_order_acquire);
+    const uint64_t first = next > kCapacity ? next - kCapacity : 0;
+    const int pid = getpid();
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool separator = false;
+    char buffer[128];
+    for (uint64_t index = first; index < next; ++index) {
+        TraceEvent& event = s_events[index % kCapacity];
+        if (event.sequence.load(std::memory_order_acquire) != index + 1)
+            continue;
+        const char* name = event.name;
+        const uint64_t timeNs = event.timeNs;
+        const uint32_t tid = event.tid;
+        const char phase = event.phase;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Overwritten meanwhile by a writer that wrapped around.
+        if (event.sequence.load(std::memory_order_relaxed) != index + 1)
+            continue;
+
+        if (separator)
+            json += ',';
+        separator = true;
+        json += "{\"name\":";
+        appendJsonString(json, name);
+        snprintf(buffer, sizeof(buffer), ",\"cat\":\"startup\",\"ph\":\"%c\",\"ts\":%" PRIu64 ".%03" PRIu64
+            ",\"pid\":%d,\"tid\":%u%s}", phase, timeNs / 1000, timeNs % 1000, pid, tid,
+            phase == 'i' ? ",\"s\":\"p\"" : "");
+        json += buffer;
+    }
+    json += "]}";
+    return json;
+}
+
+bool StartupTrace::writeTo(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+        return false;
+    const std::string json = toJson();
+    const bool written = fwrite(json.data(), 1, json.size(), file) == json.size();
+    return fclose(file) == 0 && written;
+}
+
+#else
+
+void StartupTrace::begin(const char*) noexcept
+{
+}
+
+void StartupTrace::end(const char*) noexcept
+{
+}
+
+void StartupTrace::instant(const char*) noexcept
+{
+}
+
+std::string StartupTrace::toJson()
+{
+    return "{\"traceEvents\":[]}";
+}
+
+bool StartupTrace::writeTo(const std::string&)
+{
+    return false;
+}
+
+#endif
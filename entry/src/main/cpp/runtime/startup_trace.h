@@ -0,0 +1,96 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+ * StartupTrace records trace events of the cold start path (environment
+ * setup, pump, display connect, web context, first view, renderer, first
+ * frame) into a fixed ring, and writes them as Chrome trace JSON, which
+ * chrome://tracing and ui.perfetto.dev both open.
+ *
+ * Recording is one fetch_add and a few stores on CLOCK_MONOTONIC, from any
+ * thread. Use the STARTUP_TRACE_* macros: unless the build defines
+ * WEBKITVIEW_STARTUP_TRACE (CMake option of the same name) they expand to
+ * nothing, and StartupTrace::enabled() is false.
+ */
+class StartupTrace final {
+public:
+    static constexpr unsigned kCapacity = 512;
+
+    static constexpr bool enabled()
+    {
+#if defined(WEBKITVIEW_STARTUP_TRACE) && WEBKITVIEW_STARTUP_TRACE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // `name` must outlive the trace (a string literal).
+    static void begin(const char* name) noexcept;
+    static void end(const char* name) noexcept;
+    static void instant(const char* name) noexcept;
+
+    // {"traceEvents":[...]}; once the ring has wrapped only the newest
+    // kCapacity events are left.
+    static std::string toJson();
+    static bool writeTo(const std::string& path);
+
+    class Scope final {
+    public:
+        explicit Scope(const char* name) noexcept
+            : m_name(name)
+        {
+            begin(m_name);
+        }
+        ~Scope() { end(m_name); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_name;
+    };
+};
+
+#if defined(WEBKITVIEW_STARTUP_TRACE) && WEBKITVIEW_STARTUP_TRACE
+#define STARTUP_TRACE_CONCAT_(a, b) a##b
+#define STARTUP_TRACE_CONCAT(a, b) STARTUP_TRACE_CONCAT_(a, b)
+#define STARTUP_TRACE_SCOPE(name) StartupTrace::Scope STARTUP_TRACE_CONCAT(startupTraceScope, __LINE__)(name)
+#define STARTUP_TRACE_BEGIN(name) StartupTrace::begin(name)
+#define STARTUP_TRACE_END(name) StartupTrace::end(name)
+#define STARTUP_TRACE_INSTANT(name) StartupTrace::instant(name)
+// Only the first time this line is reached in the process, e.g. first frame.
+#define STARTUP_TRACE_INSTANT_ONCE(name) \
+    do { \
+        static std::atomic<bool> s_startupTraced { false }; \
+        if (!s_startupTraced.exchange(true, std::memory_order_relaxed)) \
+            StartupTrace::instant(name); \
+    } while (0)
+#else
+#define STARTUP_TRACE_SCOPE(name) ((void)0)
+#define STARTUP_TRACE_BEGIN(name) ((void)0)
+#define STARTUP_TRACE_END(name) ((void)0)
+#define STARTUP_TRACE_INSTANT(name) ((void)0)
+#define STARTUP_TRACE_INSTANT_ONCE(name) ((void)0)
+#endif
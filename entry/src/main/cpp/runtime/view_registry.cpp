@@ -0,0 +1,96 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "view_registry.h"
+
+#include <algorithm>
+
+ViewHandle ViewRegistry::Register(const std::string& id, OH_NativeXComponent* component)
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+
+    // A re-created XComponent registers again under the id of its live entry.
+    const uint32_t count = count_.load(std::memory_order_relaxed);
+    uint32_t index = count;
+    for (uint32_t i = 0; i < count; ++i) {
+        Slot& slot = slots_[i];
+        const ViewHandle handle = slot.handle.load(std::memory_order_relaxed);
+        if (handle == kInvalidViewHandle) {
+            index = std::min(index, i);
+            continue;
+        }
+        if (slot.id == id) {
+            slot.component.store(component, std::memory_order_release);
+            return handle;
+        }
+    }
+
+    if (index == kMaxViews)
+        return kInvalidViewHandle;
+
+    Slot& slot = slots_[index];
+    const ViewHandle handle = (slot.generation << kIndexBits) | (index + 1);
+    slot.id = id;
+    slot.handle.store(handle, std::memory_order_release);
+    slot.component.store(component, std::memory_order_release);
+    if (index == count)
+        count_.store(count + 1, std::memory_order_release);
+    return handle;
+}
+
+void ViewRegistry::SetView(ViewHandle handle, WKWebView* view) noexcept
+{
+    const uint32_t index = SlotIndex(handle);
+    if (index != kMaxViews)
+        slots_[index].view.store(view, std::memory_order_release);
+}
+
+WKWebView* ViewRegistry::Unregister(ViewHandle handle) noexcept
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    const uint32_t index = SlotIndex(handle);
+    if (index == kMaxViews)
+        return nullptr;
+
+    Slot& slot = slots_[index];
+    slot.component.store(nullptr, std::memory_order_release);
+    slot.handle.store(kInvalidViewHandle, std::memory_order_release);
+    slot.generation = (slot.generation + 1) & ((1u << (32 - kIndexBits)) - 1);
+    slot.id.clear();
+    return slot.view.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+std::vector<WKWebView*> ViewRegistry::TakeViews()
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+
+    std::vector<WKWebView*> views;
+    const uint32_t count = count_.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (auto* view = slots_[i].view.exchange(nullptr, std::memory_order_acq_rel))
+            views.push_back(view);
+    }
+    return views;
+}
+
+const std::string& ViewRegistry::Id(ViewHandle handle) const noexcept
+{
+    static const std::string s_empty;
+    const uint32_t index = SlotIndex(handle);
+    return index != kMaxViews ? slots_[index].id : s_empty;
+}
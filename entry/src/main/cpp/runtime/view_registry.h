@@ -0,0 +1,149 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct OH_NativeXComponent;
+class WKWebView;
+
+// Compact identifier of a registered XComponent and its WKWebView; what
+// callbacks capture instead of the XComponent id string. The low bits are the
+// registry slot + 1, the rest the slot's generation, so a handle stops
+// matching once its view is destroyed, even after the slot is reused.
+using ViewHandle = uint32_t;
+constexpr ViewHandle kInvalidViewHandle = 0;
+
+/*
+ * ViewRegistry maps XComponents to views for WKRuntime. Entries are added and
+ * removed on the ArkTS thread, at XComponent registration and destroy(), and
+ * are looked up at event rate: by OH_NativeXComponent* on ACE callback
+ * threads, by handle on WebKit's thread. Lookups take no lock and allocate
+ * nothing.
+ *
+ * Entries live in a fixed array of kMaxViews slots, which bounds the views
+ * alive at once, not the views an app creates over its lifetime:
+ * Unregister() frees the slot for the next Register() and bumps its
+ * generation, so the old handle finds nothing rather than the slot's next
+ * view. A slot's handle, component and view are atomics of their own; a
+ * lookup re-reads the one it started from after reading the other, so an
+ * entry freed or reused in between is a miss. Slots are only ever appended
+ * past count_, and the pointer lookup is a linear scan of that many.
+ */
+class ViewRegistry final {
+public:
+    static constexpr uint32_t kMaxViews = 32;
+
+    ViewRegistry() = default;
+
+    ViewRegistry(ViewRegistry&&) = delete;
+    ViewRegistry& operator=(ViewRegistry&&) = delete;
+    ViewRegistry(const ViewRegistry&) = delete;
+    ViewRegistry& operator=(const ViewRegistry&) = delete;
+
+    // Returns the handle of `id`, adding an entry unless one is registered,
+    // and points it at `component`. kInvalidViewHandle when kMaxViews entries
+    // are registered.
+    ViewHandle Register(const std::string& id, OH_NativeXComponent* component);
+
+    // Sets the view of a registered handle; the owner creates it once.
+    void SetView(ViewHandle handle, WKWebView* view) noexcept;
+
+    // Removes the entry and returns its view (null if none), which the caller
+    // now owns. Later lookups of the handle or the component find nothing.
+    WKWebView* Unregister(ViewHandle handle) noexcept;
+
+    // Empties every entry's view and returns them, for teardown.
+    std::vector<WKWebView*> TakeViews();
+
+    ViewHandle Lookup(const OH_NativeXComponent* component) const noexcept
+    {
+        // Free slots hold a null component.
+        if (component == nullptr)
+            return kInvalidViewHandle;
+        const uint32_t count = count_.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; ++i) {
+            const Slot& slot = slots_[i];
+            if (slot.component.load(std::memory_order_acquire) != component)
+                continue;
+            const ViewHandle handle = slot.handle.load(std::memory_order_acquire);
+            // Register() publishes a reused slot's handle before its
+            // component, so a handle newer than the component read shows here.
+            return slot.component.load(std::memory_order_relaxed) == component ? handle : kInvalidViewHandle;
+        }
+        return kInvalidViewHandle;
+    }
+
+    WKWebView* View(ViewHandle handle) const noexcept
+    {
+        const uint32_t index = SlotIndex(handle);
+        if (index == kMaxViews)
+            return nullptr;
+        const Slot& slot = slots_[index];
+        WKWebView* view = slot.view.load(std::memory_order_acquire);
+        // A view set after the slot was reused comes with its new handle.
+        return slot.handle.load(std::memory_order_relaxed) == handle ? view : nullptr;
+    }
+
+    // Calls `visit(WKWebView*)` for every entry that has a view.
+    template<typename Visitor>
+    void ForEachView(Visitor&& visit) const
+    {
+        const uint32_t count = count_.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (auto* view = slots_[i].view.load(std::memory_order_acquire))
+                visit(view);
+        }
+    }
+
+    // Empty for an unknown handle. ArkTS thread only.
+    const std::string& Id(ViewHandle handle) const noexcept;
+
+private:
+    static constexpr uint32_t kIndexBits = 8;
+    static_assert(kMaxViews < (1u << kIndexBits), "slot + 1 must fit the handle's index bits");
+
+    struct Slot {
+        // kInvalidViewHandle while free.
+        std::atomic<ViewHandle> handle { kInvalidViewHandle };
+        std::atomic<OH_NativeXComponent*> component { nullptr };
+        std::atomic<WKWebView*> view { nullptr };
+        // Written under writeMutex_; wraps after 2^24 reuses of the slot.
+        uint32_t generation = 0;
+        std::string id;
+    };
+
+    // The slot of a registered handle; kMaxViews for any other.
+    uint32_t SlotIndex(ViewHandle handle) const noexcept
+    {
+        const uint32_t index = (handle & ((1u << kIndexBits) - 1)) - 1;
+        if (handle == kInvalidViewHandle || index >= count_.load(std::memory_order_acquire)
+            || slots_[index].handle.load(std::memory_order_acquire) != handle)
+            return kMaxViews;
+        return index;
+    }
+
+    std::mutex writeMutex_;
+    std::atomic<uint32_t> count_ { 0 };
+    Slot slots_[kMaxViews];
+};
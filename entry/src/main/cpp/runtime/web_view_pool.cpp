@@ -0,0 +1,127 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "web_view_pool.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "log.h"
+
+void WebViewPool::Start(uint32_t capacity, Factory factory)
+{
+    capacity_.store(capacity, std::memory_order_relaxed);
+    factory_ = factory;
+    ScheduleRefill();
+}
+
+WebKitWebView* WebViewPool::Take()
+{
+    if (views_.empty()) {
+        if (capacity_.load(std::memory_order_relaxed) > 0)
+            misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    WebKitWebView* webView = views_.back();
+    views_.pop_back();
+    available_.store(views_.size(), std::memory_order_relaxed);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    ScheduleRefill();
+    return webView;
+}
+
+void WebViewPool::Clear()
+{
+    capacity_.store(0, std::memory_order_relaxed);
+    Suspend();
+}
+
+void WebViewPool::Suspend()
+{
+    suspended_ = true;
+    if (refillSource_ != 0) {
+        g_source_remove(refillSource_);
+        refillSource_ = 0;
+    }
+    for (auto* webView : views_)
+        g_object_unref(webView);
+    views_.clear();
+    available_.store(0, std::memory_order_relaxed);
+}
+
+void WebViewPool::Resume()
+{
+    suspended_ = false;
+    ScheduleRefill();
+}
+
+void WebViewPool::RecordFirstPresent(bool pooled, int64_t initToPresentUs) noexcept
+{
+    (pooled ? pooled_ : unpooled_).Record(initToPresentUs);
+}
+
+std::string WebViewPool::ToJson() const
+{
+    char buffer[192];
+    snprintf(buffer, sizeof(buffer),
+        "{\"capacity\":%u,\"available\":%u,\"created\":%" PRIu64 ",\"hits\":%" PRIu64 ",\"misses\":%" PRIu64 ",",
+        capacity_.load(std::memory_order_relaxed), available_.load(std::memory_order_relaxed),
+        created_.load(std::memory_order_relaxed), hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed));
+    std::string json = buffer;
+
+    json += "\"initToFirstPresent\":{";
+    pooled_.AppendJson(json, "pooled");
+    json += ',';
+    unpooled_.AppendJson(json, "unpooled");
+    json += "}}";
+    return json;
+}
+
+gboolean WebViewPool::OnRefill(gpointer userData)
+{
+    auto* pool = static_cast<WebViewPool*>(userData);
+    if (pool->views_.size() >= pool->capacity_.load(std::memory_order_relaxed)) {
+        pool->refillSource_ = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    WebKitWebView* webView = pool->factory_();
+    if (webView == nullptr) {
+        LOGE("WebViewPool - failed to create a web view; refill stopped");
+        pool->refillSource_ = 0;
+        return G_SOURCE_REMOVE;
+    }
+    pool->views_.push_back(webView);
+    pool->available_.store(pool->views_.size(), std::memory_order_relaxed);
+    pool->created_.fetch_add(1, std::memory_order_relaxed);
+
+    if (pool->views_.size() < pool->capacity_.load(std::memory_order_relaxed))
+        return G_SOURCE_CONTINUE;
+    pool->refillSource_ = 0;
+    return G_SOURCE_REMOVE;
+}
+
+void WebViewPool::ScheduleRefill()
+{
+    if (refillSource_ != 0 || suspended_ || factory_ == nullptr || views_.size() >= capacity_.load(std::memory_order_relaxed))
+        return;
+    // One view per dispatch, below WebKit's own default-priority work.
+    refillSource_ = g_idle_add_full(G_PRIORITY_LOW, WebViewPool::OnRefill, this, nullptr);
+    g_source_set_name_by_id(refillSource_, "WebViewPool refill");
+}
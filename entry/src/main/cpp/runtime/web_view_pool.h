@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <wpe/webkit.h>
+
+#include "latency_stats.h"
+
+/*
+ * WebViewPool keeps a few fully constructed, unmapped WebKitWebViews so that
+ * WKWebView::Init() can adopt one instead of building it while ArkTS waits.
+ * Adopting schedules a refill, done one view per low-priority idle dispatch
+ * so it never competes with input or frames.
+ *
+ * It also collects the time from init() to a view's first presented buffer,
+ * split by whether the view came from the pool, which is what the pool is
+ * meant to shorten.
+ *
+ * Take/Start/Clear/Suspend/Resume run on WebKit's thread; RecordFirstPresent and ToJson on
+ * any thread.
+ */
+class WebViewPool final {
+public:
+    // Creates a configured web view (transfer full), on WebKit's thread.
+    using Factory = WebKitWebView* (*)();
+
+    WebViewPool() = default;
+
+    WebViewPool(WebViewPool&&) = delete;
+    WebViewPool& operator=(WebViewPool&&) = delete;
+    WebViewPool(const WebViewPool&) = delete;
+    WebViewPool& operator=(const WebViewPool&) = delete;
+
+    ~WebViewPool() = default;
+
+    void Start(uint32_t capacity, Factory factory);
+
+    // A pooled web view (transfer full), or null when the pool is empty.
+    WebKitWebView* Take();
+
+    // Releases the idle views and stops refilling.
+    void Clear();
+
+    // Releases the idle views and holds off refilling until Resume(); the
+    // capacity stays as configured. For memory pressure.
+    void Suspend();
+    void Resume();
+
+    void RecordFirstPresent(bool pooled, int64_t initToPresentUs) noexcept;
+
+    // {"capacity":N,"available":N,"created":N,"hits":N,"misses":N,
+    //  "initToFirstPresent":{"pooled":{...},"unpooled":{...}}}, times in ms.
+    std::string ToJson() const;
+
+private:
+    static gboolean OnRefill(gpointer userData);
+    void ScheduleRefill();
+
+    std::atomic<uint32_t> capacity_ { 0 };
+    Factory factory_ = nullptr;
+    guint refillSource_ = 0;
+    bool suspended_ = false;
+    std::vector<WebKitWebView*> views_;
+
+    std::atomic<uint32_t> available_ { 0 };
+    std::atomic<uint64_t> created_ { 0 };
+    std::atomic<uint64_t> hits_ { 0 };
+    std::atomic<uint64_t> misses_ { 0 };
+
+    LatencyStats pooled_;
+    LatencyStats unpooled_;
+};
@@ -0,0 +1,63 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "webkit_thread.h"
+
+#include <pthread.h>
+
+#include "log.h"
+
+WebKitThread::WebKitThread()
+    : m_context(g_main_context_ref(g_main_context_default()))
+    , m_loop(g_main_loop_new(m_context, FALSE))
+    , m_invokeQueue(std::make_unique<InvokeQueue>(m_context))
+{
+    // Posts made before the loop starts simply wait in the queue: the source
+    // is already attached and the first prepare finds it ready.
+    m_thread = std::thread([this] { run(); });
+}
+
+WebKitThread::~WebKitThread()
+{
+    // Posted rather than called directly, so that everything this thread
+    // posted before (e.g. WebKit object teardown) still runs first.
+    m_invokeQueue->post([loop = m_loop] { g_main_loop_quit(loop); });
+    if (m_thread.joinable())
+        m_thread.join();
+
+    m_invokeQueue = nullptr;
+    g_main_loop_unref(m_loop);
+    g_main_context_unref(m_context);
+}
+
+void WebKitThread::invoke(InvokeTask&& task) noexcept
+{
+    m_invokeQueue->post(std::move(task));
+}
+
+void WebKitThread::run()
+{
+    pthread_setname_np(pthread_self(), "WebKitMain");
+
+    if (!g_main_context_acquire(m_context)) {
+        LOGE("WebKitThread: failed to acquire the default GMainContext (owned by another thread?)");
+        return;
+    }
+    g_main_loop_run(m_loop);
+    g_main_context_release(m_context);
+}
@@ -0,0 +1,63 @@
+/**
+ * Copyright (C) 2026 Jani Hautakangas <jani@kodegood.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include <memory>
+#include <thread>
+
+#include "invoke_queue.h"
+#include "invoke_task.h"
+
+/*
+ * WebKitThread is the alternative to MessagePump: instead of driving GLib
+ * from the ArkTS libuv loop, WebKit's UIProcess gets a thread of its own that
+ * runs a GMainLoop on g_main_context_default(). Nothing on that thread pushes
+ * a thread-default context, so WebKit's RunLoop::main binds to the default
+ * context exactly as it does on the ArkTS thread with the pump.
+ *
+ * The first WebKit call must then be made from a task posted here, which makes
+ * this thread WebKit's main thread.
+ */
+class WebKitThread final {
+public:
+    WebKitThread();
+
+    WebKitThread(WebKitThread&&) = delete;
+    WebKitThread& operator=(WebKitThread&&) = delete;
+    WebKitThread(const WebKitThread&) = delete;
+    WebKitThread& operator=(const WebKitThread&) = delete;
+
+    // Quits the loop once every task posted so far by the calling thread has
+    // run, then joins the thread.
+    ~WebKitThread();
+
+    // Same contract as MessagePump::invoke: thread-safe, always deferred,
+    // FIFO per posting thread.
+    void invoke(InvokeTask&& task) noexcept;
+
+private:
+    void run();
+
+    GMainContext* m_context = nullptr;
+    GMainLoop* m_loop = nullptr;
+    std::unique_ptr<InvokeQueue> m_invokeQueue;
+    std::thread m_thread;
+};
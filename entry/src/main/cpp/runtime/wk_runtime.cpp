@@ -23,14 +23,18 @@
 #include <glib.h>
 #include <wpe/webkit.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "environment.h"
 #include "log.h"
 #include "message_pump.h"
+#include "startup_trace.h"
+#include "webkit_thread.h"
 
 #include "platform/wpe_display_ohos.h"
+#include "platform/wpe_view_ohos.h"
 #include "wk_web_view.h"
 
 // On OHOS, WebKit owns process launching (UIProcess/Launcher/ohos/ProcessLauncherOHOS.cpp):
@@ -96,6 +100,119 @@ bool GetEnvronmentParamsFromApplicationContext(std::vector<std::string>& outPara
     return true;
 }
 
+napi_value NapiSetPumpStatsEnabled(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    if (napi_get_cb_info(env, info, &argc, args, nullptr, nullptr) != napi_ok || argc < 1) {
+        LOGE("NapiSetPumpStatsEnabled: invalid arguments");
+        return nullptr;
+    }
+    bool enabled = false;
+    if (napi_get_value_bool(env, args[0], &enabled) != napi_ok) {
+        LOGE("NapiSetPumpStatsEnabled: napi_get_value_bool fail");
+        return nullptr;
+    }
+    WKRuntime::SetPumpStatsEnabled(enabled);
+    return nullptr;
+}
+
+napi_value NapiGetPumpStats(napi_env env, napi_callback_info /*info*/)
+{
+    const std::string snapshot = WKRuntime::GetPumpStatsSnapshot();
+    napi_value result = nullptr;
+    if (napi_create_string_utf8(env, snapshot.c_str(), snapshot.size(), &result) != napi_ok) {
+        LOGE("NapiGetPumpStats: napi_create_string_utf8 fail");
+        return nullptr;
+    }
+    return result;
+}
+
+napi_value NapiGetStallReports(napi_env env, napi_callback_info /*info*/)
+{
+    const std::string reports = WKRuntime::GetStallReports();
+    napi_value result = nullptr;
+    if (napi_create_string_utf8(env, reports.c_str(), reports.size(), &result) != napi_ok) {
+        LOGE("NapiGetStallReports: napi_create_string_utf8 fail");
+        return nullptr;
+    }
+    return result;
+}
+
+napi_value NapiGetPrewarmStats(napi_env env, napi_callback_info /*info*/)
+{
+    const std::string stats = WKRuntime::GetPrewarmStats();
+    napi_value result = nullptr;
+    if (napi_create_string_utf8(env, stats.c_str(), stats.size(), &result) != napi_ok) {
+        LOGE("NapiGetPrewarmStats: napi_create_string_utf8 fail");
+        return nullptr;
+    }
+    return result;
+}
+
+napi_value NapiWriteStartupTrace(napi_env env, napi_callback_info /*info*/)
+{
+    const std::string path = WKRuntime::WriteStartupTrace();
+    napi_value result = nullptr;
+    if (napi_create_string_utf8(env, path.c_str(), path.size(), &result) != napi_ok) {
+        LOGE("NapiWriteStartupTrace: napi_create_string_utf8 fail");
+        return nullptr;
+    }
+    return result;
+}
+
+napi_value NapiGetWebViewPoolStats(napi_env env, napi_callback_info /*info*/)
+{
+    const std::string stats = WKRuntime::GetWebViewPoolStats();
+    napi_value result = nullptr;
+    if (napi_create_string_utf8(env, stats.c_str(), stats.size(), &result) != napi_ok) {
+        LOGE("NapiGetWebViewPoolStats: napi_create_string_utf8 fail");
+        return nullptr;
+    }
+    return result;
+}
+
+napi_value NapiSetAppForeground(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1] = { nullptr };
+    bool foreground = true;
+    if (napi_get_cb_info(env, info, &argc, args, nullptr, nullptr) != napi_ok || argc < 1
+        || napi_get_value_bool(env, args[0], &foreground) != napi_ok) {
+        LOGE("NapiSetAppForeground: expected a boolean");
+        return nullptr;
+    }
+    WKRuntime::SetAppForeground(foreground);
+    return nullptr;
+}
+
+napi_value NapiGetMemoryPressureStats(napi_env env, napi_callback_info /*info*/)
+{
+    const std::string stats = WKRuntime::GetMemoryPressureStats();
+    napi_value result = nullptr;
+    if (napi_create_string_utf8(env, stats.c_str(), stats.size(), &result) != napi_ok) {
+        LOGE("NapiGetMemoryPressureStats: napi_create_string_utf8 fail");
+        return nullptr;
+    }
+    return result;
+}
+
+// napi_threadsafe_function call_js: runs one PostToArkTS task on the ArkTS
+// thread. `env` is null when the function is being torn down; the task is
+// then dropped.
+void CallArkTSTask(napi_env env, napi_value /*jsCallback*/, void* /*context*/, void* data)
+{
+    std::unique_ptr<InvokeTask> task(static_cast<InvokeTask*>(data));
+    if (env == nullptr)
+        return;
+
+    napi_handle_scope scope = nullptr;
+    napi_open_handle_scope(env, &scope);
+    (*task)();
+    if (scope != nullptr)
+        napi_close_handle_scope(env, scope);
+}
+
 } // namespace
 
 WKRuntime::WKRuntime() = default;
@@ -104,32 +221,59 @@ WKRuntime::~WKRuntime()
 {
     LOGD("WKRuntime::~WKRuntime");
 
-    for (auto& pair : wkWebViewMap_) {
-        delete pair.second;
+    auto destroyWebViews = [this, webViews = viewRegistry_.TakeViews()]() {
+        for (auto* webView : webViews)
+            delete webView;
+        memoryPressureMonitor_.Stop();
+        prewarmer_.Stop();
+        webViewPool_.Clear();
+    };
+
+    if (webKitThread_ != nullptr) {
+        // WebKit objects must go away on WebKit's thread; the thread quits
+        // once this (and anything posted before it) has run.
+        webKitThread_->invoke(std::move(destroyWebViews));
+        webKitThread_ = nullptr;
+    } else {
+        destroyWebViews();
     }
-    wkWebViewMap_.clear();
 
+    wpe_view_ohos_set_frame_clock(nullptr, nullptr);
     messagePump_ = nullptr;
     uiReady_.store(false, std::memory_order_release);
 }
 
-void WKRuntime::Initialize(uv_loop_t* loop)
+void WKRuntime::Initialize(napi_env env, uv_loop_t* loop, const Options& options)
 {
-    GetInstance().DoInitialize(loop);
+    GetInstance().DoInitialize(env, loop, options);
 }
 
-void WKRuntime::DoInitialize(uv_loop_t* loop)
+void WKRuntime::DoInitialize(napi_env env, uv_loop_t* loop, const Options& options)
 {
-    // Guard on "attempted", not on uiReady_: a second call (e.g. the napi
-    // module Init running for another env) must not construct a second
-    // MessagePump over the same default GMainContext.
+    // Guard on "attempted", not on uiReady_: every view's init() calls this,
+    // and a second call must neither construct a second MessagePump /
+    // WebKitThread over the same default GMainContext nor switch modes. The
+    // first caller's options win.
     if (initialized_)
         return;
     initialized_ = true;
+    prewarmer_.SetOrigin(g_get_monotonic_time());
+    prewarmMode_ = options.prewarm;
+    webViewPoolSize_ = options.webViewPoolSize;
+    directPresent_ = options.directPresent;
+    memoryPressureIntervalMs_ = options.memoryPressureIntervalMs;
+    memoryPressureThresholds_ = options.memoryPressure;
+
+    STARTUP_TRACE_SCOPE("WKRuntime::DoInitialize");
 
     std::vector<std::string> params;
     params.push_back("WPEUIProcess");
-    if (GetEnvronmentParamsFromApplicationContext(params)) {
+    STARTUP_TRACE_BEGIN("GetEnvronmentParamsFromApplicationContext");
+    const bool haveDirs = GetEnvronmentParamsFromApplicationContext(params);
+    STARTUP_TRACE_END("GetEnvronmentParamsFromApplicationContext");
+    if (haveDirs) {
+        cacheDir_ = params[1];
+        STARTUP_TRACE_SCOPE("Environment::Initialize");
         Environment::Initialize(params);
     } else {
         // Environment::Initialize indexes params[1..4]; without the dirs it
@@ -138,16 +282,63 @@ void WKRuntime::DoInitialize(uv_loop_t* loop)
         LOGE("WKRuntime::DoInitialize - ApplicationContext dirs unavailable; environment not initialised");
     }
 
+    CreateArkTSDispatcher(env);
+
+    if (options.threadMode == ThreadMode::Dedicated) {
+        // WebKit's thread owns the default GMainContext; StartWebKit is its
+        // first task, which makes that thread WebKit's main thread.
+        LOGD("WKRuntime::DoInitialize - running WebKit on a dedicated thread");
+        webKitThread_ = std::make_unique<WebKitThread>();
+        webKitThread_->invoke([this]() { StartWebKit(); });
+        return;
+    }
+
     // Drive WebKit's GLib run loop from this (the ArkTS) thread's libuv loop.
     // WebKit runs on the ArkTS thread, which owns the default GMainContext the
     // pump services.
-    messagePump_ = std::make_unique<MessagePump>(loop);
+    STARTUP_TRACE_BEGIN("MessagePump::MessagePump");
+    messagePump_ = std::make_unique<MessagePump>(loop, options.pump);
+    STARTUP_TRACE_END("MessagePump::MessagePump");
+    if (options.stallThresholdMs > 0) {
+        StallWatchdog::Options watchdog;
+        watchdog.thresholdMs = options.stallThresholdMs;
+        // tools/recv-webkitview-faultlog.sh stall fetches these.
+        if (haveDirs)
+            watchdog.dumpDirectory = params[2] + "/faultlog";
+        messagePump_->enableStallWatchdog(watchdog);
+    }
+    // Timer slack rounds GLib timeouts to the displayed frames' vsyncs.
+    wpe_view_ohos_set_frame_clock([](gint64 frameTime, gint64 frameInterval, gpointer userData) {
+        static_cast<MessagePump*>(userData)->setFrameTiming(frameTime, static_cast<uint32_t>(frameInterval));
+    }, messagePump_.get());
+    StartWebKit();
+}
 
+void WKRuntime::CreateArkTSDispatcher(napi_env env)
+{
+    napi_value resourceName = nullptr;
+    napi_create_string_utf8(env, "WebKitViewArkTSDispatch", NAPI_AUTO_LENGTH, &resourceName);
+    if (napi_create_threadsafe_function(env, nullptr, nullptr, resourceName, 0, 1, nullptr, nullptr, nullptr,
+            CallArkTSTask, &arkTSDispatcher_) != napi_ok) {
+        LOGE("WKRuntime::CreateArkTSDispatcher - napi_create_threadsafe_function failed; events to ArkTS are dropped");
+        arkTSDispatcher_ = nullptr;
+        return;
+    }
+    // Like the pump's uv handles: never keep the ArkTS loop alive on its own.
+    napi_unref_threadsafe_function(env, arkTSDispatcher_);
+}
+
+void WKRuntime::StartWebKit()
+{
+    STARTUP_TRACE_SCOPE("WKRuntime::StartWebKit");
     wpeDisplay_ = wpe_display_ohos_new();
 
     GError* error = nullptr;
-    if (!wpe_display_connect(wpeDisplay_, &error)) {
-        LOGE("WKRuntime::DoInitialize - failed to connect display: %{public}s",
+    STARTUP_TRACE_BEGIN("wpe_display_connect");
+    const bool connected = wpe_display_connect(wpeDisplay_, &error);
+    STARTUP_TRACE_END("wpe_display_connect");
+    if (!connected) {
+        LOGE("WKRuntime::StartWebKit - failed to connect display: %{public}s",
             error ? error->message : "unknown error");
         if (error != nullptr)
             g_error_free(error);
@@ -155,44 +346,49 @@ void WKRuntime::DoInitialize(uv_loop_t* loop)
         return;
     }
 
-    // Load-bearing: this is the first WTF-touching WebKit call, made on the
-    // ArkTS thread with no thread-default GMainContext pushed. It triggers
-    // webkitInitialize() -> WTF::initializeMainThread(), claiming this thread
-    // as WebKit's main thread and binding RunLoop::main to
-    // g_main_context_default() — the context the MessagePump services. If any
-    // WTF-touching call ever precedes this on another thread, RunLoop::main
-    // binds a private context nobody pumps and WebKit silently hangs.
+    // Load-bearing: this is the first WTF-touching WebKit call, made on
+    // WebKit's thread (the ArkTS thread, or WebKitThread) with no
+    // thread-default GMainContext pushed. It triggers webkitInitialize() ->
+    // WTF::initializeMainThread(), claiming this thread as WebKit's main thread
+    // and binding RunLoop::main to g_main_context_default() — the context the
+    // MessagePump / WebKitThread services. If any WTF-touching call ever
+    // precedes this on another thread, RunLoop::main binds a private context
+    // nobody pumps and WebKit silently hangs.
     // Web views created without an explicit web-context use the default one
     // (get_default is transfer-none, so nothing to unref here).
+    STARTUP_TRACE_BEGIN("webkit_web_context_get_default");
     webkit_web_context_get_default();
+    STARTUP_TRACE_END("webkit_web_context_get_default");
+    prewarmer_.Mark(ProcessPrewarmer::Phase::UIProcessReady);
+
+    // Before the flush: the launches are asynchronous, and starting them
+    // first lets them overlap with the queued view inits.
+    prewarmer_.Start(prewarmMode_, wpeDisplay_);
+    webViewPool_.Start(webViewPoolSize_, &WKWebView::CreateWebKitWebView);
+    memoryPressureMonitor_.Start(memoryPressureIntervalMs_, memoryPressureThresholds_, &WKRuntime::OnMemoryPressure);
 
-    uiReady_.store(true, std::memory_order_release);
     FlushPendingInvokesOnUIReady();
-    FlushPendingInitsOnUIReady();
 }
 
 void WKRuntime::FailInitialize()
 {
     initFailed_.store(true, std::memory_order_release);
 
-    // Nothing will ever flush the pending queues; run the destroy callbacks so
-    // queued payloads are not leaked, and drop queued view inits.
-    std::vector<PendingInvoke> invokes;
+    // Nothing will ever flush the pending queue; drop the queued tasks (which
+    // releases their captures), view inits included.
+    std::vector<InvokeTask> invokes;
     {
         std::lock_guard<std::mutex> lock(pendingInvokeMutex_);
         invokes.swap(pendingInvokes_);
     }
-    for (const auto& invoke : invokes) {
-        if (invoke.destroy != nullptr)
-            invoke.destroy(invoke.callbackData);
-    }
+    invokes.clear();
 
-    {
-        std::lock_guard<std::mutex> lock(pendingInitMutex_);
-        pendingInitialization_.clear();
+    // The pump can go; a dedicated WebKitThread (whose task this is) stays
+    // idle until the runtime is destroyed.
+    if (messagePump_ != nullptr) {
+        wpe_view_ohos_set_frame_clock(nullptr, nullptr);
+        messagePump_ = nullptr;
     }
-
-    messagePump_ = nullptr;
 }
 
 bool WKRuntime::Export(napi_env env, napi_value exports)
@@ -200,6 +396,20 @@ bool WKRuntime::Export(napi_env env, napi_value exports)
     LOGD("WKRuntime::Export");
     napi_status status;
 
+    napi_property_descriptor desc[] = {
+        {"setPumpStatsEnabled", nullptr, NapiSetPumpStatsEnabled, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"getPumpStats", nullptr, NapiGetPumpStats, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"getStallReports", nullptr, NapiGetStallReports, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"getPrewarmStats", nullptr, NapiGetPrewarmStats, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"writeStartupTrace", nullptr, NapiWriteStartupTrace, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"getWebViewPoolStats", nullptr, NapiGetWebViewPoolStats, nullptr, nullptr, nullptr, napi_default,
+            nullptr},
+        {"getMemoryPressureStats", nullptr, NapiGetMemoryPressureStats, nullptr, nullptr, nullptr, napi_default,
+            nullptr},
+        {"setAppForeground", nullptr, NapiSetAppForeground, nullptr, nullptr, nullptr, napi_default, nullptr},
+    };
+    napi_define_properties(env, exports, sizeof(desc) / sizeof(desc[0]), desc);
+
     napi_value exportInstance = nullptr;
     OH_NativeXComponent* nativeXComponent = nullptr;
 
@@ -238,102 +448,174 @@ WPEDisplay* WKRuntime::GetWPEDisplay()
     return GetInstance().GetWPEDisplayInternal();
 }
 
-WKWebView* WKRuntime::GetWebView(const std::string& id)
+void WKRuntime::RequestWebViewInit(ViewHandle handle)
 {
-    return GetInstance().GetWebViewInternal(id);
+    GetInstance().DoRequestWebViewInit(handle);
 }
 
-void WKRuntime::RequestWebViewInit(const std::string& id)
+void WKRuntime::SetPumpStatsEnabled(bool enabled)
 {
-    GetInstance().DoRequestWebViewInit(id);
+    auto& runtime = GetInstance();
+    if (runtime.messagePump_ == nullptr)
+        return;
+    runtime.messagePump_->setStatsEnabled(enabled);
 }
 
-void WKRuntime::Invoke(void (* callback)(void*), void* callbackData, void (* destroy)(void*))
+std::string WKRuntime::GetPumpStatsSnapshot()
 {
-    GetInstance().DoInvoke(callback, callbackData, destroy);
+    auto& runtime = GetInstance();
+    if (runtime.messagePump_ == nullptr || runtime.messagePump_->stats() == nullptr)
+        return "null";
+    return runtime.messagePump_->stats()->toJson();
 }
 
-void WKRuntime::RegisterNativeXComponent(const std::string& id, OH_NativeXComponent* nativeXComponent)
+std::string WKRuntime::GetStallReports()
 {
-   if (nativeXComponentMap_.find(id) == nativeXComponentMap_.end()) {
-        nativeXComponentMap_[id] = nativeXComponent;
-   } else {
-        if (nativeXComponentMap_[id] != nativeXComponent) {
-            nativeXComponentMap_[id] = nativeXComponent;
-        }
-   }
-   GetWebViewInternal(id)->RegisterCallbacks(nativeXComponent);
+    auto& runtime = GetInstance();
+    if (runtime.messagePump_ == nullptr || runtime.messagePump_->stallWatchdog() == nullptr)
+        return "null";
+    return runtime.messagePump_->stallWatchdog()->toJson();
 }
 
-WPEDisplay* WKRuntime::GetWPEDisplayInternal() const
+std::string WKRuntime::WriteStartupTrace()
 {
-    return wpeDisplay_;
+    auto& runtime = GetInstance();
+    if (!StartupTrace::enabled() || runtime.cacheDir_.empty())
+        return std::string();
+
+    const std::string path = runtime.cacheDir_ + "/webkitview-startup-trace.json";
+    if (!StartupTrace::writeTo(path)) {
+        LOGE("WKRuntime::WriteStartupTrace - failed to write %{public}s", path.c_str());
+        return std::string();
+    }
+    return path;
 }
 
-WKWebView* WKRuntime::GetWebViewInternal(const std::string& id)
+std::string WKRuntime::GetPrewarmStats()
 {
-    if (wkWebViewMap_.find(id) == wkWebViewMap_.end()) {
-        WKWebView* webView = new WKWebView(id);
-        wkWebViewMap_[id] = webView;
-        return webView;
-    }
-    return wkWebViewMap_[id];
+    return GetInstance().prewarmer_.ToJson();
 }
 
-void WKRuntime::DoRequestWebViewInit(const std::string& id)
+WebKitWebView* WKRuntime::TakePrewarmedWebView()
 {
-    if (initFailed_.load(std::memory_order_acquire)) {
-        LOGE("WKRuntime::DoRequestWebViewInit - runtime initialization failed; ignoring '%{public}s'", id.c_str());
+    return GetInstance().prewarmer_.TakeWebView();
+}
+
+WebKitWebView* WKRuntime::TakePooledWebView()
+{
+    return GetInstance().webViewPool_.Take();
+}
+
+std::string WKRuntime::GetWebViewPoolStats()
+{
+    return GetInstance().webViewPool_.ToJson();
+}
+
+void WKRuntime::SetAppForeground(bool foreground)
+{
+    auto& runtime = GetInstance();
+    if (runtime.appForeground_.exchange(foreground, std::memory_order_relaxed) == foreground)
         return;
-    }
 
-    if (uiReady_.load(std::memory_order_acquire)) {
-        auto* data = new std::string(id);
-        DoInvoke(
-            [](void* p){
-                auto* s = static_cast<std::string*>(p);
-                if (auto* wv = WKRuntime::GetInstance().GetWebViewInternal(*s))
-                    wv->Init();
-            },
-            data,
-            [](void* p){ delete static_cast<std::string*>(p); }
-        );
+    LOGD("WKRuntime::SetAppForeground - %{public}s", foreground ? "foreground" : "background");
+    Post(InvokeTask::inlineOnly([foreground]() {
+        GetInstance().viewRegistry_.ForEachView([foreground](WKWebView* webView) {
+            webView->SetAppForeground(foreground);
+        });
+    }));
+}
+
+std::string WKRuntime::GetMemoryPressureStats()
+{
+    return GetInstance().memoryPressureMonitor_.ToJson();
+}
+
+void WKRuntime::OnMemoryPressure(MemoryPressure::Level level)
+{
+    // There is no public API to hand WebKit a system pressure event, so shed
+    // what the embedder API reaches: the memory caches of every process, and
+    // under critical pressure the idle views kept for fast view creation,
+    // which the pool builds again once the pressure is over.
+    auto& runtime = GetInstance();
+    if (level == MemoryPressure::Level::None) {
+        runtime.webViewPool_.Resume();
         return;
     }
 
-    {
-        std::lock_guard<std::mutex> lock(pendingInitMutex_);
-        if (std::find(pendingInitialization_.begin(), pendingInitialization_.end(), id) == pendingInitialization_.end())
-            pendingInitialization_.push_back(id);
+    auto* manager = webkit_network_session_get_website_data_manager(webkit_network_session_get_default());
+    webkit_website_data_manager_clear(manager, WEBKIT_WEBSITE_DATA_MEMORY_CACHE, 0, nullptr, nullptr, nullptr);
+
+    if (level == MemoryPressure::Level::Critical) {
+        runtime.prewarmer_.Stop();
+        runtime.webViewPool_.Suspend();
     }
 }
 
-void WKRuntime::FlushPendingInitsOnUIReady()
+void WKRuntime::RegisterNativeXComponent(const std::string& id, OH_NativeXComponent* nativeXComponent)
 {
-    std::vector<std::string> ids;
-    {
-        std::lock_guard<std::mutex> lock(pendingInitMutex_);
-        if (pendingInitialization_.empty())
-            return;
-        ids.swap(pendingInitialization_);
+    const ViewHandle handle = viewRegistry_.Register(id, nativeXComponent);
+    if (handle == kInvalidViewHandle) {
+        LOGE("WKRuntime::RegisterNativeXComponent - more than %{public}u live views; ignoring '%{public}s'",
+            ViewRegistry::kMaxViews, id.c_str());
+        return;
     }
 
-    for (const auto& id : ids) {
-        if (auto* wv = GetWebViewInternal(id))
-            wv->Init();
+    // Export runs on the ArkTS thread only, so the view is created once per
+    // registration; a re-created XComponent whose view was destroyed was
+    // unregistered with it and gets a new view under a new handle.
+    if (viewRegistry_.View(handle) == nullptr)
+        viewRegistry_.SetView(handle, new WKWebView(id, handle));
+    WKWebView::RegisterCallbacks(nativeXComponent);
+}
+
+void WKRuntime::DestroyWebView(ViewHandle handle)
+{
+    auto& registry = GetInstance().viewRegistry_;
+    LOGD("WKRuntime::DestroyWebView - '%{public}s'", registry.Id(handle).c_str());
+    WKWebView* webView = registry.Unregister(handle);
+    if (webView == nullptr)
+        return;
+
+    // Tasks already queued for the handle find no view; the delete runs after
+    // them, on WebKit's thread like every other use of the view.
+    Post(InvokeTask::inlineOnly([webView]() { delete webView; }));
+}
+
+WPEDisplay* WKRuntime::GetWPEDisplayInternal() const
+{
+    return wpeDisplay_;
+}
+
+void WKRuntime::DoRequestWebViewInit(ViewHandle handle)
+{
+    if (handle == kInvalidViewHandle) {
+        LOGE("WKRuntime::DoRequestWebViewInit - XComponent was never registered");
+        return;
+    }
+    if (initFailed_.load(std::memory_order_acquire)) {
+        LOGE("WKRuntime::DoRequestWebViewInit - runtime initialization failed; ignoring '%{public}s'",
+            viewRegistry_.Id(handle).c_str());
+        return;
     }
+
+    // Queued like any other post until WebKit is up, so the init keeps its
+    // place relative to the surface and load requests around it. Init() is
+    // idempotent.
+    DoPost(InvokeTask::inlineOnly([handle]() {
+        if (auto* wv = WKRuntime::GetWebView(handle))
+            wv->Init();
+    }));
 }
 
-void WKRuntime::DoInvoke(void (* callback)(void*), void* callbackData, void (* destroy)(void*))
+void WKRuntime::DoPost(InvokeTask&& task)
 {
     // The message pump (and the GLib context it services) is created in
-    // DoInitialize. Until it is ready, queue invokes instead of dispatching to
+    // DoInitialize. Until it is ready, queue tasks instead of dispatching to
     // a null pump (which otherwise crashes when ACE fires e.g. OnSurfaceCreated
     // before init).
     if (initFailed_.load(std::memory_order_acquire)) {
-        // Initialization failed permanently; don't queue into a void.
-        if (destroy != nullptr)
-            destroy(callbackData);
+        // Initialization failed permanently; don't queue into a void. The
+        // task is destroyed unrun when it goes out of scope.
         return;
     }
 
@@ -342,30 +624,58 @@ void WKRuntime::DoInvoke(void (* callback)(void*), void* callbackData, void (* d
         // Re-check under the lock: FlushPendingInvokesOnUIReady() runs after
         // uiReady_ is set, so anything queued here is guaranteed to be flushed.
         if (!uiReady_.load(std::memory_order_acquire)) {
-            pendingInvokes_.push_back({callback, callbackData, destroy});
+            pendingInvokes_.push_back(std::move(task));
             return;
         }
     }
 
-    DispatchInvoke(callback, callbackData, destroy);
+    DispatchPost(std::move(task));
 }
 
 void WKRuntime::FlushPendingInvokesOnUIReady()
 {
-    std::vector<PendingInvoke> invokes;
-    {
-        std::lock_guard<std::mutex> lock(pendingInvokeMutex_);
-        invokes.swap(pendingInvokes_);
-    }
+    // Runs on WebKit's thread. Tasks queued before WebKit was up run here,
+    // directly; uiReady_ is only set under the lock once the queue is empty.
+    // A concurrent DoPost (from the ArkTS thread in ThreadMode::Dedicated)
+    // therefore either lands in a batch drained here, or is dispatched after
+    // all of them, keeping FIFO order across the transition.
+    STARTUP_TRACE_SCOPE("WKRuntime::FlushPendingInvokesOnUIReady");
+    for (;;) {
+        std::vector<InvokeTask> invokes;
+        {
+            std::lock_guard<std::mutex> lock(pendingInvokeMutex_);
+            if (pendingInvokes_.empty()) {
+                uiReady_.store(true, std::memory_order_release);
+                return;
+            }
+            invokes.swap(pendingInvokes_);
+        }
 
-    for (const auto& invoke : invokes) {
-        DispatchInvoke(invoke.callback, invoke.callbackData, invoke.destroy);
+        for (auto& invoke : invokes)
+            invoke();
     }
 }
 
-void WKRuntime::DispatchInvoke(void (* callback)(void*), void* callbackData, void (* destroy)(void*))
+void WKRuntime::DispatchPost(InvokeTask&& task)
 {
+    if (webKitThread_ != nullptr) {
+        webKitThread_->invoke(std::move(task));
+        return;
+    }
     // Post to the GLib context via the pump; the context wakeup fd is observed
-    // by libuv, so the callback runs on the ArkTS/GLib thread.
-    messagePump_->invoke(callback, destroy, callbackData);
+    // by libuv, so the task runs on the ArkTS/GLib thread.
+    messagePump_->invoke(std::move(task));
+}
+
+void WKRuntime::DoPostToArkTS(InvokeTask&& task)
+{
+    if (arkTSDispatcher_ == nullptr)
+        return;
+
+    // The threadsafe function carries a single pointer per call.
+    auto* queued = new InvokeTask(std::move(task));
+    if (napi_call_threadsafe_function(arkTSDispatcher_, queued, napi_tsfn_nonblocking) != napi_ok) {
+        LOGE("WKRuntime::DoPostToArkTS - napi_call_threadsafe_function failed; task dropped");
+        delete queued;
+    }
 }
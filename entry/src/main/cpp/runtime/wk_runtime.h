@@ -21,7 +21,7 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <ace/xcomponent/native_interface_xcomponent.h>
@@ -30,15 +30,54 @@
 
 #include <wpe/webkit.h>
 
-class MessagePump;
+#include "invoke_task.h"
+#include "memory_pressure_monitor.h"
+#include "message_pump.h"
+#include "process_prewarmer.h"
+#include "web_view_pool.h"
+#include "view_registry.h"
+
+class WebKitThread;
 class WKWebView;
 
 class WKRuntime final {
 public:
-    // Sets up the UIProcess environment and drives WebKit's GLib run loop from
-    // the given libuv loop (the ArkTS main-thread event loop). Must be called
-    // once, on the thread that owns `loop`.
-    static void Initialize(uv_loop_t* loop);
+    enum class ThreadMode {
+        // WebKit's main thread is the ArkTS thread: MessagePump drives WebKit's
+        // GLib run loop from the ArkTS libuv loop.
+        ArkTS,
+        // WebKit runs on a thread of its own with a GMainLoop (WebKitThread);
+        // ArkTS callbacks post to it, events come back through PostToArkTS.
+        Dedicated,
+    };
+
+    struct Options {
+        ThreadMode threadMode = ThreadMode::ArkTS;
+        // ThreadMode::ArkTS only.
+        MessagePump::Options pump;
+        // ThreadMode::ArkTS only: report pump dispatches longer than this
+        // (StallWatchdog), to the app's files/faultlog directory; 0 = off.
+        uint32_t stallThresholdMs = 0;
+        // Launch the WebProcess and NetworkProcess (and optionally load a
+        // blank page for the first view to adopt) as soon as WebKit is up.
+        ProcessPrewarmer::Mode prewarm = ProcessPrewarmer::Mode::None;
+        // Constructed web views kept ready for init() to adopt (WebViewPool);
+        // 0 = off.
+        uint32_t webViewPoolSize = 0;
+        // Present WebKit's buffers without a copy (WPEViewOHOSDirectRenderer)
+        // when they fit the surface; off until validated on more devices.
+        bool directPresent = false;
+        // Poll interval of the MemoryPressureMonitor that replaces WebKit's
+        // disabled one, and the levels it reacts to; 0 = off. 2000 is a
+        // reasonable interval to opt in with.
+        uint32_t memoryPressureIntervalMs = 0;
+        MemoryPressure::Thresholds memoryPressure;
+    };
+
+    // Sets up the UIProcess environment and starts WebKit on the thread
+    // selected by `options`. Must be called on the ArkTS thread that owns `env`
+    // and `loop`; only the first call has any effect.
+    static void Initialize(napi_env env, uv_loop_t* loop, const Options& options);
 
     static bool Export(napi_env env, napi_value exports);
 
@@ -46,11 +85,99 @@ public:
 
     static WPEDisplay* GetWPEDisplay();
 
-    static WKWebView* GetWebView(const std::string& id);
+    // Handle of a registered XComponent, kInvalidViewHandle otherwise. Lock-free
+    // and allocation-free; safe from ACE callback threads.
+    static ViewHandle GetViewHandle(const OH_NativeXComponent* component) noexcept
+    {
+        return GetInstance().viewRegistry_.Lookup(component);
+    }
 
-    static void RequestWebViewInit(const std::string& id);
+    // The view behind `handle`; WebKit's thread only.
+    static WKWebView* GetWebView(ViewHandle handle) noexcept
+    {
+        return GetInstance().viewRegistry_.View(handle);
+    }
 
-    static void Invoke(void (* callback)(void*), void* callbackData, void (* destroy)(void*));
+    static void RequestWebViewInit(ViewHandle handle);
+
+    // Detaches the view from its XComponent and tears it down on WebKit's
+    // thread. ArkTS thread.
+    static void DestroyWebView(ViewHandle handle);
+
+    // Ability foreground/background, applied to every view (and to views
+    // created later). ArkTS thread.
+    static void SetAppForeground(bool foreground);
+    static bool IsAppForeground() noexcept
+    {
+        return GetInstance().appForeground_.load(std::memory_order_relaxed);
+    }
+
+    // Options::directPresent; WebKit's thread.
+    static bool DirectPresentEnabled() noexcept
+    {
+        return GetInstance().directPresent_;
+    }
+
+    // MessagePump instrumentation (see MessagePumpStats). The snapshot is
+    // compact JSON, or "null" while stats are disabled or WebKit runs on a
+    // dedicated thread.
+    static void SetPumpStatsEnabled(bool enabled);
+    static std::string GetPumpStatsSnapshot();
+
+    // StallWatchdog reports as JSON, or "null" while it is off.
+    static std::string GetStallReports();
+
+    // Cold start phase times and prewarm state (ProcessPrewarmer) as JSON.
+    static std::string GetPrewarmStats();
+
+    // Writes the StartupTrace events as Chrome trace JSON to the app's cache
+    // directory and returns the file's path; empty if the build has no
+    // WEBKITVIEW_STARTUP_TRACE or writing failed.
+    static std::string WriteStartupTrace();
+
+    // Records a cold start phase; any thread, first mark per phase only.
+    static void MarkStartupPhase(ProcessPrewarmer::Phase phase) noexcept
+    {
+        GetInstance().prewarmer_.Mark(phase);
+    }
+
+    // The prewarmed blank-page web view (transfer full), for the first view
+    // to adopt; null otherwise. WebKit's thread only.
+    static WebKitWebView* TakePrewarmedWebView();
+
+    // A web view from the WebViewPool (transfer full), or null. WebKit's
+    // thread only.
+    static WebKitWebView* TakePooledWebView();
+
+    // Time from a view's Init() to its first presented buffer.
+    static void RecordFirstPresent(bool pooled, int64_t initToPresentUs) noexcept
+    {
+        GetInstance().webViewPool_.RecordFirstPresent(pooled, initToPresentUs);
+    }
+
+    // WebViewPool state and init-to-first-present timings as JSON.
+    static std::string GetWebViewPoolStats();
+
+    // MemoryPressureMonitor's last reading and event counts as JSON.
+    static std::string GetMemoryPressureStats();
+
+    // Runs `callable` on the WebKit (GLib) thread. Captures up to
+    // InvokeTask::kInlineCapacity bytes are stored without a heap allocation.
+    // If the runtime never becomes ready the callable is destroyed unrun.
+    template<typename Callable>
+    static void Post(Callable&& callable)
+    {
+        GetInstance().DoPost(InvokeTask(std::forward<Callable>(callable)));
+    }
+
+    // Runs `callable` on the ArkTS thread, always deferred, through a
+    // napi_threadsafe_function; used to deliver WebKit results and events to
+    // JS in either thread mode. Dropped if the runtime was never initialized.
+    template<typename Callable>
+    static void PostToArkTS(Callable&& callable)
+    {
+        GetInstance().DoPostToArkTS(InvokeTask(std::forward<Callable>(callable)));
+    }
 
 private:
 
@@ -65,41 +192,55 @@ private:
 
     void RegisterNativeXComponent(const std::string& id, OH_NativeXComponent* nativeXComponent);
     WPEDisplay* GetWPEDisplayInternal() const;
-    WKWebView* GetWebViewInternal(const std::string& id);
 
-    void DoInitialize(uv_loop_t* loop);
+    void DoInitialize(napi_env env, uv_loop_t* loop, const Options& options);
+    void CreateArkTSDispatcher(napi_env env);
+    // Runs on WebKit's thread.
+    void StartWebKit();
 
-    void DoRequestWebViewInit(const std::string& id);
-    void FlushPendingInitsOnUIReady();
+    void DoRequestWebViewInit(ViewHandle handle);
 
-    void DoInvoke(void (* callback)(void*), void* callbackData, void (* destroy)(void*));
-    void DispatchInvoke(void (* callback)(void*), void* callbackData, void (* destroy)(void*));
+    void DoPost(InvokeTask&& task);
+    void DispatchPost(InvokeTask&& task);
     void FlushPendingInvokesOnUIReady();
-
-    struct PendingInvoke {
-        void (* callback)(void*);
-        void* callbackData;
-        void (* destroy)(void*);
-    };
+    void DoPostToArkTS(InvokeTask&& task);
 
     void FailInitialize();
 
+    // MemoryPressureMonitor handler, on WebKit's thread.
+    static void OnMemoryPressure(MemoryPressure::Level level);
+
+    // Exactly one of these drives WebKit, depending on ThreadMode.
     std::unique_ptr<MessagePump> messagePump_;
+    std::unique_ptr<WebKitThread> webKitThread_;
+    napi_threadsafe_function arkTSDispatcher_ = nullptr;
     // Set when DoInitialize first runs (attempted), regardless of outcome.
     // Only touched on the ArkTS thread.
     bool initialized_ = false;
     std::atomic<bool> uiReady_{false};
     std::atomic<bool> initFailed_{false};
-
-    std::mutex pendingInitMutex_;
-    std::vector<std::string> pendingInitialization_;
+    std::atomic<bool> appForeground_{true};
 
     std::mutex pendingInvokeMutex_;
-    std::vector<PendingInvoke> pendingInvokes_;
+    std::vector<InvokeTask> pendingInvokes_;
 
     WPEDisplay* wpeDisplay_ = nullptr;
-
-    std::unordered_map<std::string, OH_NativeXComponent*> nativeXComponentMap_;
-    std::unordered_map<std::string, WKWebView*> wkWebViewMap_;
+    // ApplicationContext cache dir; empty if unavailable.
+    std::string cacheDir_;
+
+    // Written before WebKit starts; used on WebKit's thread.
+    ProcessPrewarmer::Mode prewarmMode_ = ProcessPrewarmer::Mode::None;
+    ProcessPrewarmer prewarmer_;
+    uint32_t webViewPoolSize_ = 0;
+    WebViewPool webViewPool_;
+    bool directPresent_ = false;
+    uint32_t memoryPressureIntervalMs_ = 0;
+    MemoryPressure::Thresholds memoryPressureThresholds_;
+    MemoryPressureMonitor memoryPressureMonitor_;
+
+    // Views are created on the ArkTS thread (XComponent registration) and
+    // looked up from ACE callback threads and WebKit's thread, which differ in
+    // ThreadMode::Dedicated.
+    ViewRegistry viewRegistry_;
 };
 
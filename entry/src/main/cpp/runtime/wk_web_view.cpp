@@ -18,144 +18,140 @@
 
 #include "wk_web_view.h"
 
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+#include "latency_stats.h"
 #include "log.h"
+#include "startup_trace.h"
 #include "wk_runtime.h"
 
+#include "platform/direct/wpe_view_ohos_direct_renderer.h"
 #include "platform/gles3/wpe_view_ohos_gles3_renderer.h"
+#include "platform/wpe_toplevel_ohos.h"
 #include "platform/wpe_view_ohos.h"
 
 namespace {
 
+// ACE delivers touch events at input rate and an OH_NativeXComponent_TouchEvent
+// is large (room for OH_MAX_TOUCH_POINTS_NUMBER points), so rather than
+// allocating one per event they are recycled from a fixed pool. Events are
+// taken on the ACE callback thread and returned on the GLib thread once
+// dispatched; the occupancy bitmap makes both sides lock-free.
+class TouchEventPool final {
+public:
+    static TouchEventPool& Get()
+    {
+        static TouchEventPool s_pool;
+        return s_pool;
+    }
+
+    OH_NativeXComponent_TouchEvent* Acquire()
+    {
+        uint64_t used = used_.load(std::memory_order_relaxed);
+        while (used != ~uint64_t(0)) {
+            const int index = __builtin_ctzll(~used);
+            if (used_.compare_exchange_weak(used, used | (uint64_t(1) << index),
+                std::memory_order_acquire, std::memory_order_relaxed))
+                return &events_[index];
+        }
+        // Exhausted (GLib thread stalled behind a burst): fall back to the heap.
+        return new OH_NativeXComponent_TouchEvent;
+    }
+
+    void Release(OH_NativeXComponent_TouchEvent* event)
+    {
+        if (event < events_ || event >= events_ + kPoolSize) {
+            delete event;
+            return;
+        }
+        const auto index = static_cast<unsigned>(event - events_);
+        used_.fetch_and(~(uint64_t(1) << index), std::memory_order_release);
+    }
+
+private:
+    static constexpr unsigned kPoolSize = 64;
+
+    OH_NativeXComponent_TouchEvent events_[kPoolSize];
+    std::atomic<uint64_t> used_{0};
+};
+
+struct TouchEventDeleter {
+    void operator()(OH_NativeXComponent_TouchEvent* event) const
+    {
+        TouchEventPool::Get().Release(event);
+    }
+};
+
+using PooledTouchEvent = std::unique_ptr<OH_NativeXComponent_TouchEvent, TouchEventDeleter>;
+
 void OnSurfaceCreatedCB(OH_NativeXComponent* component, void* window)
 {
-    auto id = WKRuntime::GetXComponentId(component);
-    uint64_t width, height = 0;
+    const ViewHandle handle = WKRuntime::GetViewHandle(component);
+    uint64_t width = 0, height = 0;
     OH_NativeXComponent_GetXComponentSize(component, window, &width, &height);
 
-    struct CallbackData
-    {
-        std::string id;
-        void* window;
-        uint64_t width;
-        uint64_t height;
-    }; 
-
-    auto* data = new CallbackData{ id, window, width, height };
-    WKRuntime::Invoke(
-        [](void* data) {
-            auto* callbackData = static_cast<CallbackData*>(data);
-            auto* webView = WKRuntime::GetWebView(callbackData->id);
-            if (webView != nullptr) {
-                webView->OnSurfaceCreated(
-                    static_cast<OHNativeWindow*>(callbackData->window),
-                    static_cast<int>(callbackData->width),
-                    static_cast<int>(callbackData->height)
-                );  
-            }
-        },
-        data,
-        [](void* data) {
-            delete static_cast<CallbackData*>(data);
+    WKRuntime::Post(InvokeTask::inlineOnly([handle, window, width, height]() {
+        auto* webView = WKRuntime::GetWebView(handle);
+        if (webView != nullptr) {
+            webView->OnSurfaceCreated(
+                static_cast<OHNativeWindow*>(window),
+                static_cast<int>(width),
+                static_cast<int>(height)
+            );
         }
-    );
+    }));
 }
 
 void OnSurfaceChangedCB(OH_NativeXComponent* component, void* window)
 {
-    auto id = WKRuntime::GetXComponentId(component);
+    const ViewHandle handle = WKRuntime::GetViewHandle(component);
     uint64_t width = 0, height = 0;
     OH_NativeXComponent_GetXComponentSize(component, window, &width, &height);
 
-    struct CallbackData
-    {
-        std::string id;
-        void* window;
-        uint64_t width;
-        uint64_t height;
-    }; 
-
-    auto* data = new CallbackData{ id, window, width, height };
-    WKRuntime::Invoke(
-        [](void* data) {
-            auto* callbackData = static_cast<CallbackData*>(data);
-            auto* webView = WKRuntime::GetWebView(callbackData->id);
-            if (webView != nullptr) {
-                webView->OnSurfaceChanged(
-                    static_cast<OHNativeWindow*>(callbackData->window),
-                    static_cast<int>(callbackData->width),
-                    static_cast<int>(callbackData->height)
-                );
-            }
-        },
-        data,
-        [](void* data) {
-            delete static_cast<CallbackData*>(data);
+    WKRuntime::Post(InvokeTask::inlineOnly([handle, window, width, height]() {
+        auto* webView = WKRuntime::GetWebView(handle);
+        if (webView != nullptr) {
+            webView->OnSurfaceChanged(
+                static_cast<OHNativeWindow*>(window),
+                static_cast<int>(width),
+                static_cast<int>(height)
+            );
         }
-    );
+    }));
 }
 
 void OnSurfaceDestroyedCB(OH_NativeXComponent *component, void *window)
 {
-    auto id = WKRuntime::GetXComponentId(component);
+    const ViewHandle handle = WKRuntime::GetViewHandle(component);
 
-    struct CallbackData
-    {
-        std::string id;
-        void* window;
-    };
-
-    auto* data = new CallbackData{ id, window };
-    WKRuntime::Invoke(
-        [](void* data) {
-            auto* callbackData = static_cast<CallbackData*>(data);
-            auto* webView = WKRuntime::GetWebView(callbackData->id);
-            if (webView != nullptr) {
-                webView->OnSurfaceDestroyed(
-                    static_cast<OHNativeWindow*>(callbackData->window)
-                );
-            }
-        },
-        data,
-        [](void* data) {
-            delete static_cast<CallbackData*>(data);
+    WKRuntime::Post(InvokeTask::inlineOnly([handle, window]() {
+        auto* webView = WKRuntime::GetWebView(handle);
+        if (webView != nullptr) {
+            webView->OnSurfaceDestroyed(static_cast<OHNativeWindow*>(window));
         }
-    );
+    }));
 }
 
 void DispatchTouchEventCB(OH_NativeXComponent *component, void *window)
 {
-    auto id = WKRuntime::GetXComponentId(component);
+    const ViewHandle handle = WKRuntime::GetViewHandle(component);
 
-    auto touchEvent = new OH_NativeXComponent_TouchEvent;
-    int32_t ret = OH_NativeXComponent_GetTouchEvent(component, window, touchEvent);
+    PooledTouchEvent touchEvent(TouchEventPool::Get().Acquire());
+    int32_t ret = OH_NativeXComponent_GetTouchEvent(component, window, touchEvent.get());
     if (ret != OH_NATIVEXCOMPONENT_RESULT_SUCCESS) {
-        delete touchEvent;
         return;
     }
 
-    struct CallbackData
-    {
-        std::string id;
-        OH_NativeXComponent_TouchEvent* touchEvent;
-    }; 
-
-    auto* data = new CallbackData{ id, touchEvent };
-    WKRuntime::Invoke(
-        [](void* data) {
-            auto* callbackData = static_cast<CallbackData*>(data);
-            auto* webView = WKRuntime::GetWebView(callbackData->id);
-            if (webView != nullptr) {
-                webView->DispatchTouchEvent(callbackData->touchEvent);
-            }
-        },
-        data,
-        [](void* data) {
-            auto* callbackData = static_cast<CallbackData*>(data);
-            delete callbackData->touchEvent;
-            delete callbackData;
+    WKRuntime::Post(InvokeTask::inlineOnly([handle, touchEvent = std::move(touchEvent)]() {
+        auto* webView = WKRuntime::GetWebView(handle);
+        if (webView != nullptr) {
+            webView->DispatchTouchEvent(touchEvent.get());
         }
-    );
+    }));
 }
+
 napi_value NapiLoadURL(napi_env env, napi_callback_info info)
 {
     size_t argc = 1;
@@ -195,36 +191,289 @@ napi_value NapiLoadURL(napi_env env, napi_callback_info info)
         return nullptr;
     }
 
-    auto id = WKRuntime::GetXComponentId(nativeXComponent);
-
-    struct CallbackData
-    {
-        std::string id;
-        std::string url;
-    };
+    const ViewHandle handle = WKRuntime::GetViewHandle(nativeXComponent);
 
-    auto* callbackData = new CallbackData{ id, url };
-    WKRuntime::Invoke(
-        [](void* data){
-            auto* callbackData = static_cast<CallbackData*>(data);
-            auto* webView = WKRuntime::GetWebView(callbackData->id);
-            if (webView != nullptr) {
-                webView->LoadURL(callbackData->url);
-            }
-        },
-        callbackData,
-        [](void* data) {
-            delete static_cast<CallbackData*>(data);
+    WKRuntime::Post([handle, url = std::move(url)]() {
+        auto* webView = WKRuntime::GetWebView(handle);
+        if (webView != nullptr) {
+            webView->LoadURL(url);
         }
-    );
+    });
 
     return nullptr;
 }
 
+napi_value NapiSetVisible(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1] = { nullptr };
+    napi_value thisArg;
+    if (napi_get_cb_info(env, info, &argc, args, &thisArg, nullptr) != napi_ok) {
+        LOGE("NapiSetVisible: napi_get_cb_info fail");
+        return nullptr;
+    }
+
+    bool visible = true;
+    if (argc < 1 || napi_get_value_bool(env, args[0], &visible) != napi_ok) {
+        LOGE("NapiSetVisible: expected a boolean");
+        return nullptr;
+    }
+
+    napi_value exportInstance;
+    if (napi_get_named_property(env, thisArg, OH_NATIVE_XCOMPONENT_OBJ, &exportInstance) != napi_ok) {
+        LOGE("NapiSetVisible: napi_get_named_property fail");
+        return nullptr;
+    }
+
+    OH_NativeXComponent* nativeXComponent = nullptr;
+    if (napi_unwrap(env, exportInstance, reinterpret_cast<void**>(&nativeXComponent)) != napi_ok) {
+        LOGE("NapiSetVisible: napi_unwrap fail");
+        return nullptr;
+    }
+
+    const ViewHandle handle = WKRuntime::GetViewHandle(nativeXComponent);
+    WKRuntime::Post([handle, visible]() {
+        auto* webView = WKRuntime::GetWebView(handle);
+        if (webView != nullptr)
+            webView->SetVisible(visible);
+    });
+    return nullptr;
+}
+
+napi_value NapiSetFrameRate(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1] = { nullptr };
+    napi_value thisArg;
+    if (napi_get_cb_info(env, info, &argc, args, &thisArg, nullptr) != napi_ok) {
+        LOGE("NapiSetFrameRate: napi_get_cb_info fail");
+        return nullptr;
+    }
+
+    uint32_t fps = 0;
+    if (argc < 1 || napi_get_value_uint32(env, args[0], &fps) != napi_ok) {
+        LOGE("NapiSetFrameRate: expected a number");
+        return nullptr;
+    }
+
+    napi_value exportInstance;
+    if (napi_get_named_property(env, thisArg, OH_NATIVE_XCOMPONENT_OBJ, &exportInstance) != napi_ok) {
+        LOGE("NapiSetFrameRate: napi_get_named_property fail");
+        return nullptr;
+    }
+
+    OH_NativeXComponent* nativeXComponent = nullptr;
+    if (napi_unwrap(env, exportInstance, reinterpret_cast<void**>(&nativeXComponent)) != napi_ok) {
+        LOGE("NapiSetFrameRate: napi_unwrap fail");
+        return nullptr;
+    }
+
+    const ViewHandle handle = WKRuntime::GetViewHandle(nativeXComponent);
+    WKRuntime::Post([handle, fps]() {
+        auto* webView = WKRuntime::GetWebView(handle);
+        if (webView != nullptr)
+            webView->SetFrameRate(static_cast<int>(fps));
+    });
+    return nullptr;
+}
+
+// A drag-resize or split-screen gesture sends a size per frame; WebKit is
+// told the size once the sizes stop for this long.
+constexpr guint kResizeDebounceMs = 100;
+
+// Time from OnSurfaceCreated to the first frame presented on that surface,
+// split by whether the renderer kept its EGL context from an earlier surface,
+// and the surface size changes against the relayouts they caused.
+struct SurfaceTimings {
+    LatencyStats newContext;
+    LatencyStats keptContext;
+    std::atomic<uint64_t> sizeChanges{0};
+    std::atomic<uint64_t> relayouts{0};
+};
+
+SurfaceTimings& SurfaceStats()
+{
+    static SurfaceTimings s_timings;
+    return s_timings;
+}
+
+napi_value NapiGetSurfaceStats(napi_env env, napi_callback_info /*info*/)
+{
+    std::string stats = "{\"surfaceToFirstPresent\":{";
+    SurfaceStats().newContext.AppendJson(stats, "newContext");
+    stats += ',';
+    SurfaceStats().keptContext.AppendJson(stats, "keptContext");
+    stats += "},\"resize\":{\"sizeChanges\":";
+    stats += std::to_string(SurfaceStats().sizeChanges.load(std::memory_order_relaxed));
+    stats += ",\"relayouts\":";
+    stats += std::to_string(SurfaceStats().relayouts.load(std::memory_order_relaxed));
+    stats += "},";
+    wpe_view_ohos_get_render_stats().AppendJson(stats, "renderCpu");
+    stats += ',';
+    wpe_view_ohos_get_frame_interval_stats().AppendJson(stats, "frameInterval");
+    guint64 importHits = 0, importMisses = 0;
+    wpe_view_ohos_get_import_stats(&importHits, &importMisses);
+    stats += ",\"textureCache\":{\"hits\":";
+    stats += std::to_string(importHits);
+    stats += ",\"misses\":";
+    stats += std::to_string(importMisses);
+    uint64_t frames = 0, pixelsDrawn = 0, surfacePixels = 0;
+    WPEViewOHOSGLES3Renderer::GetPixelStats(&frames, &pixelsDrawn, &surfacePixels);
+    stats += "},\"pixels\":{\"frames\":";
+    stats += std::to_string(frames);
+    stats += ",\"drawnPerFrame\":";
+    stats += std::to_string(frames ? pixelsDrawn / frames : 0);
+    stats += ",\"surfacePerFrame\":";
+    stats += std::to_string(frames ? surfacePixels / frames : 0);
+    stats += "},\"directPresents\":";
+    stats += std::to_string(wpe_view_ohos_get_direct_presents());
+    stats += '}';
+
+    napi_value result = nullptr;
+    if (napi_create_string_utf8(env, stats.c_str(), stats.size(), &result) != napi_ok) {
+        LOGE("NapiGetSurfaceStats: napi_create_string_utf8 fail");
+        return nullptr;
+    }
+    return result;
+}
+
+// setLoadChangedListener() callbacks by view handle. They belong to the
+// ArkTS env, so this map is only touched on the ArkTS thread; WebKit reaches it
+// through WKRuntime::PostToArkTS.
+struct LoadChangedListener {
+    napi_env env = nullptr;
+    napi_ref callback = nullptr;
+};
+
+std::unordered_map<ViewHandle, LoadChangedListener>& LoadChangedListeners()
+{
+    static std::unordered_map<ViewHandle, LoadChangedListener> s_listeners;
+    return s_listeners;
+}
+
+void ClearLoadChangedListener(ViewHandle handle)
+{
+    auto& listeners = LoadChangedListeners();
+    auto it = listeners.find(handle);
+    if (it == listeners.end())
+        return;
+    napi_delete_reference(it->second.env, it->second.callback);
+    listeners.erase(it);
+}
+
+const char* LoadEventName(WebKitLoadEvent loadEvent)
+{
+    switch (loadEvent) {
+    case WEBKIT_LOAD_STARTED:
+        return "started";
+    case WEBKIT_LOAD_REDIRECTED:
+        return "redirected";
+    case WEBKIT_LOAD_COMMITTED:
+        return "committed";
+    case WEBKIT_LOAD_FINISHED:
+        return "finished";
+    }
+    return "unknown";
+}
+
+napi_value NapiSetLoadChangedListener(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1] = { nullptr };
+    napi_value thisArg;
+
+    if (napi_get_cb_info(env, info, &argc, args, &thisArg, nullptr) != napi_ok) {
+        LOGE("NapiSetLoadChangedListener: napi_get_cb_info fail");
+        return nullptr;
+    }
+
+    napi_value exportInstance;
+    if (napi_get_named_property(env, thisArg, OH_NATIVE_XCOMPONENT_OBJ, &exportInstance) != napi_ok) {
+        LOGE("NapiSetLoadChangedListener: napi_get_named_property fail");
+        return nullptr;
+    }
+
+    OH_NativeXComponent* nativeXComponent = nullptr;
+    if (napi_unwrap(env, exportInstance, reinterpret_cast<void**>(&nativeXComponent)) != napi_ok) {
+        LOGE("NapiSetLoadChangedListener: napi_unwrap fail");
+        return nullptr;
+    }
+
+    const ViewHandle handle = WKRuntime::GetViewHandle(nativeXComponent);
+    ClearLoadChangedListener(handle);
+
+    // Anything but a function (e.g. undefined) just removes the listener.
+    napi_valuetype type = napi_undefined;
+    if (argc < 1 || napi_typeof(env, args[0], &type) != napi_ok || type != napi_function)
+        return nullptr;
+
+    LoadChangedListener listener;
+    listener.env = env;
+    if (napi_create_reference(env, args[0], 1, &listener.callback) != napi_ok) {
+        LOGE("NapiSetLoadChangedListener: napi_create_reference fail");
+        return nullptr;
+    }
+    LoadChangedListeners()[handle] = listener;
+
+    return nullptr;
+}
+
+// Runs on the ArkTS thread.
+void NotifyLoadChanged(ViewHandle handle, WebKitLoadEvent loadEvent, const std::string& uri)
+{
+    auto& listeners = LoadChangedListeners();
+    auto it = listeners.find(handle);
+    if (it == listeners.end())
+        return;
+
+    napi_env env = it->second.env;
+    napi_value callback;
+    if (napi_get_reference_value(env, it->second.callback, &callback) != napi_ok || callback == nullptr)
+        return;
+
+    napi_value argv[2];
+    napi_value undefined;
+    napi_create_string_utf8(env, LoadEventName(loadEvent), NAPI_AUTO_LENGTH, &argv[0]);
+    napi_create_string_utf8(env, uri.c_str(), uri.size(), &argv[1]);
+    napi_get_undefined(env, &undefined);
+    if (napi_call_function(env, undefined, callback, 2, argv, nullptr) != napi_ok)
+        LOGE("NotifyLoadChanged: load-changed listener threw for view %{public}u", handle);
+}
+
+napi_value NapiDestroy(napi_env env, napi_callback_info info)
+{
+    napi_value thisArg;
+    if (napi_get_cb_info(env, info, nullptr, nullptr, &thisArg, nullptr) != napi_ok) {
+        LOGE("NapiDestroy: napi_get_cb_info fail");
+        return nullptr;
+    }
+
+    napi_value exportInstance;
+    if (napi_get_named_property(env, thisArg, OH_NATIVE_XCOMPONENT_OBJ, &exportInstance) != napi_ok) {
+        LOGE("NapiDestroy: napi_get_named_property fail");
+        return nullptr;
+    }
+
+    OH_NativeXComponent* nativeXComponent = nullptr;
+    if (napi_unwrap(env, exportInstance, reinterpret_cast<void**>(&nativeXComponent)) != napi_ok) {
+        LOGE("NapiDestroy: napi_unwrap fail");
+        return nullptr;
+    }
+
+    const ViewHandle handle = WKRuntime::GetViewHandle(nativeXComponent);
+    if (handle == kInvalidViewHandle)
+        return nullptr;
+
+    ClearLoadChangedListener(handle);
+    WKRuntime::DestroyWebView(handle);
+    return nullptr;
+}
+
 } // namespace
 
-WKWebView::WKWebView(const std::string& id)
+WKWebView::WKWebView(const std::string& id, ViewHandle handle)
     : id_(id)
+    , handle_(handle)
 {
     LOGD("WKWebView::WKWebView id: %{public}s", id.c_str());
 }
@@ -233,27 +482,45 @@ WKWebView::~WKWebView()
 {
     LOGD("WKWebView::~WKWebView id: %{public}s", id_.c_str());
 
+    if (resizeSource_ != 0)
+        g_source_remove(resizeSource_);
+
+    // The WPEView is owned by webView_, so stop it from rendering and drop
+    // the renderer (and its EGL surface) first, while it is still alive.
+    if (wpeView_ != nullptr) {
+        wpe_view_ohos_set_present_callback(wpeView_, nullptr, nullptr);
+        wpe_view_unmap(WPE_VIEW(wpeView_));
+        wpe_view_ohos_set_renderer(wpeView_, nullptr);
+    }
+    if (wpeViewRenderer_ != nullptr) {
+        wpeViewRenderer_->Cleanup();
+        wpeViewRenderer_.reset();
+    }
+
     for (auto handler : signalHandlers_) {
         g_signal_handler_disconnect(webView_, handler);
     }
     signalHandlers_.clear();
 
+    // Last reference: WebKit closes the page, and terminates its WebProcess
+    // once no other page uses it.
     if (webView_ != nullptr) {
         g_object_unref(webView_);
         webView_ = nullptr;
     }
-
-    if (wpeViewRenderer_ != nullptr) {
-        wpe_view_ohos_set_renderer(wpeView_, nullptr);
-        wpeViewRenderer_->Cleanup();
-        wpeViewRenderer_.reset();
-    }
+    wpeView_ = nullptr;
 }
 
 bool WKWebView::Export(napi_env env, napi_value exports)
 {
     napi_property_descriptor desc[] = {
         {"loadURL", nullptr, NapiLoadURL, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"setLoadChangedListener", nullptr, NapiSetLoadChangedListener, nullptr, nullptr, nullptr, napi_default,
+            nullptr},
+        {"destroy", nullptr, NapiDestroy, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"setVisible", nullptr, NapiSetVisible, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"setFrameRate", nullptr, NapiSetFrameRate, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"getSurfaceStats", nullptr, NapiGetSurfaceStats, nullptr, nullptr, nullptr, napi_default, nullptr},
     };
     napi_define_properties(env, exports, sizeof(desc) / sizeof(desc[0]), desc);
 
@@ -262,11 +529,16 @@ bool WKWebView::Export(napi_env env, napi_value exports)
 
 void WKWebView::RegisterCallbacks(OH_NativeXComponent* component)
 {
-    callback_.OnSurfaceCreated = OnSurfaceCreatedCB;
-    callback_.OnSurfaceChanged = OnSurfaceChangedCB;
-    callback_.OnSurfaceDestroyed = OnSurfaceDestroyedCB;
-    callback_.DispatchTouchEvent = DispatchTouchEventCB;
-    OH_NativeXComponent_RegisterCallback(component, &callback_);
+    // ACE keeps the pointer.
+    static OH_NativeXComponent_Callback s_callback = [] {
+        OH_NativeXComponent_Callback callback = {};
+        callback.OnSurfaceCreated = OnSurfaceCreatedCB;
+        callback.OnSurfaceChanged = OnSurfaceChangedCB;
+        callback.OnSurfaceDestroyed = OnSurfaceDestroyedCB;
+        callback.DispatchTouchEvent = DispatchTouchEventCB;
+        return callback;
+    }();
+    OH_NativeXComponent_RegisterCallback(component, &s_callback);
 }
 
 void WKWebView::OnSurfaceCreated(OHNativeWindow* window, int width, int height)
@@ -275,24 +547,73 @@ void WKWebView::OnSurfaceCreated(OHNativeWindow* window, int width, int height)
     width_ = width;
     height_ = height;
 
-    if (wpeViewRenderer_ == nullptr && wpeView_ != nullptr)
-        InitializeRenderer();
+    if (wpeView_ == nullptr)
+        return;
+    surfaceStartTime_ = g_get_monotonic_time();
+    wpe_view_ohos_set_present_callback(wpeView_, WKWebView::OnPresent, this);
+    InitializeRenderer();
 }
 
 void WKWebView::OnSurfaceChanged(OHNativeWindow* window, int width, int height)
 {
+    nativeWindow_ = window;
+    if (width == width_ && height == height_)
+        return;
+    width_ = width;
+    height_ = height;
+
+    // Without a renderer the size goes to WebKit when InitializeRenderer()
+    // attaches one.
+    if (wpeView_ == nullptr || wpeViewRenderer_ == nullptr)
+        return;
+    SurfaceStats().sizeChanges.fetch_add(1, std::memory_order_relaxed);
+
+    // The last frame is stretched to the new size at once; WebKit relays the
+    // page out when the gesture settles and its next frame replaces it.
+    wpeViewRenderer_->Resize(width_, height_);
+    wpe_view_ohos_redraw(wpeView_);
+
+    if (resizeSource_ != 0)
+        g_source_remove(resizeSource_);
+    resizeSource_ = g_timeout_add_full(G_PRIORITY_DEFAULT, kResizeDebounceMs, WKWebView::OnResizeTimeout, this, nullptr);
+    g_source_set_name_by_id(resizeSource_, "WKWebView resize");
+}
+
+gboolean WKWebView::OnResizeTimeout(gpointer userData)
+{
+    auto* wkWebView = static_cast<WKWebView*>(userData);
+    wkWebView->resizeSource_ = 0;
+    wkWebView->SendSize();
+    return G_SOURCE_REMOVE;
+}
+
+void WKWebView::SendSize()
+{
+    if (resizeSource_ != 0) {
+        g_source_remove(resizeSource_);
+        resizeSource_ = 0;
+    }
+    if (wpe_view_get_width(WPE_VIEW(wpeView_)) == width_ && wpe_view_get_height(WPE_VIEW(wpeView_)) == height_)
+        return;
+    SurfaceStats().relayouts.fetch_add(1, std::memory_order_relaxed);
+    wpe_view_ohos_resize(wpeView_, width_, height_);
 }
 
 void WKWebView::OnSurfaceDestroyed(OHNativeWindow* window)
 {
+    nativeWindow_ = nullptr;
     if (!wpeView_)
       return;
-    wpe_view_ohos_set_renderer(wpeView_, nullptr);
 
-    if (wpeViewRenderer_ != nullptr) {
-        wpeViewRenderer_->Cleanup();
-        wpeViewRenderer_.reset();
-    }
+    // Unmapped, WebKit stops rendering the page until InitializeRenderer()
+    // maps it on the next surface. Only the EGL surface goes, and the next
+    // surface reuses the context; releasing it detaches the buffers on the
+    // window, so all the buffers WebKit is owed can go back.
+    wpe_view_unmap(WPE_VIEW(wpeView_));
+    if (wpeViewRenderer_ != nullptr)
+        wpeViewRenderer_->ReleaseSurface();
+    wpe_view_ohos_release_buffers(wpeView_);
+    wpe_view_ohos_set_renderer(wpeView_, nullptr);
 }
 
 void WKWebView::DispatchTouchEvent(OH_NativeXComponent_TouchEvent* touchEvent)
@@ -307,11 +628,24 @@ void WKWebView::Init()
     }
 
     LOGD("WKWebView::Init");
-    webView_ = WEBKIT_WEB_VIEW(g_object_new(
-        WEBKIT_TYPE_WEB_VIEW,
-        "display", WKRuntime::GetWPEDisplay(),
-        nullptr
-    ));
+    STARTUP_TRACE_SCOPE("WKWebView::Init");
+    WKRuntime::MarkStartupPhase(ProcessPrewarmer::Phase::FirstViewInit);
+
+    // With prewarming, the first view takes over the blank-page view and
+    // with it an initialized WebProcess. Its about:blank load may still be
+    // finishing; those events are not this view's to report.
+    initStartTime_ = g_get_monotonic_time();
+    webView_ = WKRuntime::TakePrewarmedWebView();
+    if (webView_ != nullptr) {
+        LOGD("WKWebView::Init - adopted the prewarmed web view");
+        ignoreLoadEvents_ = true;
+        ConfigureWebKitWebView(webView_);
+    } else if ((webView_ = WKRuntime::TakePooledWebView()) != nullptr) {
+        LOGD("WKWebView::Init - adopted a pooled web view");
+        pooled_ = true;
+    } else {
+        webView_ = CreateWebKitWebView();
+    }
 
     if (webView_ == nullptr) {
         LOGE("Failed to create WebKitWebView");
@@ -323,6 +657,10 @@ void WKWebView::Init()
         LOGE("Failed to get WPEViewOHOS from WebKitWebView");
         return;
     }
+    wpe_view_ohos_set_present_callback(wpeView_, WKWebView::OnPresent, this);
+    wpe_view_ohos_set_frame_rate(wpeView_, frameRate_);
+    appForeground_ = WKRuntime::IsAppForeground();
+    ApplyVisibility();
 
     signalHandlers_.push_back(
         g_signal_connect_swapped(webView_, "load-changed", G_CALLBACK(WKWebView::OnLoadChanged), this));
@@ -335,10 +673,7 @@ void WKWebView::Init()
     auto* data_manager = webkit_network_session_get_website_data_manager(network_session);
     webkit_network_session_set_tls_errors_policy(network_session, WEBKIT_TLS_ERRORS_POLICY_IGNORE);
 
-    auto* settings = webkit_web_view_get_settings(webView_);
-    webkit_settings_set_user_agent(settings, "Mozilla/5.0 (Linux; OpenHarmony 6.0) AppleWebKit/605.1.15 (KHTML, like Gecko) Version/60.5 Mobile Safari/605.1.15");
-
-    if (nativeWindow_ != nullptr && wpeViewRenderer_ == nullptr)
+    if (nativeWindow_ != nullptr)
         InitializeRenderer();
 
     if (!pendingURL_.empty()) {
@@ -348,6 +683,40 @@ void WKWebView::Init()
     }
 }
 
+WebKitWebView* WKWebView::CreateWebKitWebView()
+{
+    auto* webView = WEBKIT_WEB_VIEW(g_object_new(
+        WEBKIT_TYPE_WEB_VIEW,
+        "display", WKRuntime::GetWPEDisplay(),
+        nullptr
+    ));
+    if (webView != nullptr)
+        ConfigureWebKitWebView(webView);
+    return webView;
+}
+
+void WKWebView::ConfigureWebKitWebView(WebKitWebView* webView)
+{
+    auto* settings = webkit_web_view_get_settings(webView);
+    webkit_settings_set_user_agent(settings, "Mozilla/5.0 (Linux; OpenHarmony 6.0) AppleWebKit/605.1.15 (KHTML, like Gecko) Version/60.5 Mobile Safari/605.1.15");
+}
+
+void WKWebView::OnPresent(gpointer userData)
+{
+    auto* wkWebView = static_cast<WKWebView*>(userData);
+    const int64_t now = g_get_monotonic_time();
+    if (wkWebView->initStartTime_ != 0) {
+        WKRuntime::RecordFirstPresent(wkWebView->pooled_, now - wkWebView->initStartTime_);
+        wkWebView->initStartTime_ = 0;
+    }
+    if (wkWebView->surfaceStartTime_ != 0) {
+        auto& stats = SurfaceStats();
+        (wkWebView->surfaceKeptContext_ ? stats.keptContext : stats.newContext).Record(now - wkWebView->surfaceStartTime_);
+        wkWebView->surfaceStartTime_ = 0;
+    }
+    wpe_view_ohos_set_present_callback(wkWebView->wpeView_, nullptr, nullptr);
+}
+
 void WKWebView::InitializeRenderer()
 {
     LOGD("WKWebView::InitializeRenderer");
@@ -355,23 +724,72 @@ void WKWebView::InitializeRenderer()
         LOGE("Cannot initialize renderer: nativeWindow_ is nullptr");
         return;
     }
+
+    // A renderer that outlived its surface only needs a new one.
+    surfaceKeptContext_ = false;
     if (wpeViewRenderer_ != nullptr) {
-        LOGD("Renderer already initialized");
-        return;
+        if (wpeViewRenderer_->SetSurface(nativeWindow_, width_, height_)) {
+            surfaceKeptContext_ = true;
+        } else {
+            LOGE("Failed to set the renderer's surface; recreating the renderer");
+            wpeViewRenderer_->Cleanup();
+            wpeViewRenderer_.reset();
+        }
     }
 
-    wpeViewRenderer_ = std::make_shared<WPEViewOHOSGLES3Renderer>();
-    if (!wpeViewRenderer_->Initialize(nativeWindow_, width_, height_)) {
-        LOGE("Failed to initialize WPEView renderer");
-        wpeViewRenderer_ = nullptr;
-        return;
+    if (wpeViewRenderer_ == nullptr) {
+        if (WKRuntime::DirectPresentEnabled())
+            wpeViewRenderer_ = std::make_shared<WPEViewOHOSDirectRenderer>();
+        else
+            wpeViewRenderer_ = std::make_shared<WPEViewOHOSGLES3Renderer>();
+        if (!wpeViewRenderer_->Initialize(nativeWindow_, width_, height_)) {
+            LOGE("Failed to initialize WPEView renderer");
+            wpeViewRenderer_->Cleanup();
+            wpeViewRenderer_ = nullptr;
+            return;
+        }
     }
 
     wpe_view_ohos_set_renderer(wpeView_, wpeViewRenderer_);
-    wpe_view_ohos_resize(wpeView_, width_, height_);
+    SendSize();
     wpe_view_map(WPE_VIEW(wpeView_));
 }
 
+void WKWebView::SetVisible(bool visible)
+{
+    visible_ = visible;
+    ApplyVisibility();
+}
+
+void WKWebView::SetFrameRate(int fps)
+{
+    frameRate_ = fps;
+    // Init() applies it once the WPEView exists.
+    if (wpeView_ != nullptr)
+        wpe_view_ohos_set_frame_rate(wpeView_, fps);
+}
+
+void WKWebView::SetAppForeground(bool foreground)
+{
+    appForeground_ = foreground;
+    ApplyVisibility();
+}
+
+void WKWebView::ApplyVisibility()
+{
+    // Init() applies the state once the WPEView exists.
+    if (wpeView_ == nullptr)
+        return;
+
+    auto* view = WPE_VIEW(wpeView_);
+    const bool visible = visible_ && appForeground_;
+    if (static_cast<bool>(wpe_view_get_visible(view)) != visible) {
+        LOGD("WKWebView::ApplyVisibility - '%{public}s' %{public}s", id_.c_str(), visible ? "shown" : "hidden");
+        wpe_view_set_visible(view, visible);
+    }
+    if (auto* toplevel = wpe_view_get_toplevel(view))
+        wpe_toplevel_ohos_set_active(toplevel, appForeground_);
+}
 
 void WKWebView::LoadURL(const std::string& url)
 {
@@ -383,16 +801,26 @@ void WKWebView::LoadURL(const std::string& url)
         return;
     }
     LOGD("WKWebView::LoadURL - url: %{public}s", url.c_str());
+    ignoreLoadEvents_ = false;
     webkit_web_view_load_uri(webView_, url.c_str());
 }
 
 void WKWebView::OnLoadChanged(WKWebView* wkWebView, WebKitLoadEvent loadEvent, WebKitWebView* /*webView*/) noexcept
 {
     LOGD("WKWebView::OnLoadChanged - loadEvent: %{public}d", static_cast<int>(loadEvent));
+    if (wkWebView->ignoreLoadEvents_)
+        return;
+    if (loadEvent == WEBKIT_LOAD_COMMITTED)
+        WKRuntime::MarkStartupPhase(ProcessPrewarmer::Phase::FirstLoadCommitted);
+
+    const char* uri = webkit_web_view_get_uri(wkWebView->webView_);
     if (loadEvent == WEBKIT_LOAD_FINISHED) {
-        const char* uri = webkit_web_view_get_uri(wkWebView->webView_);
         LOGD("WKWebView::onLoadChanged - Load finished, current URI: %{public}s", uri);
     }
+
+    WKRuntime::PostToArkTS([handle = wkWebView->handle_, loadEvent, uri = std::string(uri ? uri : "")]() {
+        NotifyLoadChanged(handle, loadEvent, uri);
+    });
 }
 
 int WKWebView::OnLoadFailed(WKWebView* wkWebView, WebKitLoadEvent loadEvent, const char* failingURI, GError* error, WebKitWebView* webView) noexcept
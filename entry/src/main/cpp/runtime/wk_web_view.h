@@ -27,21 +27,38 @@
 
 #include <wpe/webkit.h>
 
+#include "view_registry.h"
+
 class WPEViewOHOSRenderer;
 typedef struct _WPEViewOHOS WPEViewOHOS;
 
 class WKWebView final {
 public:
-    WKWebView(const std::string& id);
+    WKWebView(const std::string& id, ViewHandle handle);
     ~WKWebView();
 
     static bool Export(napi_env env, napi_value exports);
 
-    void RegisterCallbacks(OH_NativeXComponent* component);
+    // A configured, unmapped WebKitWebView (transfer full); WebViewPool's
+    // factory. WebKit's thread only.
+    static WebKitWebView* CreateWebKitWebView();
+
+    // The callbacks are shared by all views and find theirs by ViewHandle, so
+    // they stay valid across destroy() and XComponent re-creation.
+    static void RegisterCallbacks(OH_NativeXComponent* component);
 
     void Init();
     void LoadURL(const std::string& url);
 
+    // The view is shown only while both its XComponent is visible and the
+    // ability is in the foreground. Hidden, WebKit throttles the page's
+    // rAF, timers and media and the view presents no frames.
+    void SetVisible(bool visible);
+    void SetAppForeground(bool foreground);
+    // Presents at most fps frames per second, on every Nth vsync, e.g. 30
+    // for a video page on a 120 Hz panel; 0 follows the display.
+    void SetFrameRate(int fps);
+
     // ACE XComponent callbacks
     void OnSurfaceCreated(OHNativeWindow* window, int width, int height);
     void OnSurfaceChanged(OHNativeWindow* window, int width, int height);
@@ -51,6 +68,15 @@ public:
 private:
 
     void InitializeRenderer();
+    // Sends width_ x height_ to WebKit now, if it differs from the view's
+    // size, and drops a debounced resize.
+    void SendSize();
+    static gboolean OnResizeTimeout(gpointer userData);
+    void ApplyVisibility();
+    static void ConfigureWebKitWebView(WebKitWebView* webView);
+    // Records the init-to-first-present and surface-to-first-present times
+    // that are pending, then unsets itself.
+    static void OnPresent(gpointer userData);
 
 
     static void OnLoadChanged(WKWebView* wkWebView, WebKitLoadEvent loadEvent, WebKitWebView* webView) noexcept;
@@ -62,7 +88,7 @@ private:
                                                  void                *user_data) noexcept;
 
     std::string id_;
-    OH_NativeXComponent_Callback callback_;
+    ViewHandle handle_ = kInvalidViewHandle;
 
     OHNativeWindow* nativeWindow_ = nullptr;
     int width_ = 0;
@@ -76,6 +102,27 @@ private:
     // can be dispatched out of order onto the WPE main loop.
     std::string pendingURL_;
 
+    // Set while an adopted prewarmed view may still report its about:blank
+    // load; cleared by the first LoadURL().
+    bool ignoreLoadEvents_ = false;
+
+    // Init() start (monotonic us) and whether webView_ came from the
+    // WebViewPool, for the init-to-first-present timing.
+    int64_t initStartTime_ = 0;
+    bool pooled_ = false;
+
+    // OnSurfaceCreated() time and whether that surface's renderer kept its
+    // EGL context, for the surface-to-first-present timing.
+    int64_t surfaceStartTime_ = 0;
+    bool surfaceKeptContext_ = false;
+
+    // Debounced wpe_view_ohos_resize() after OnSurfaceChanged().
+    guint resizeSource_ = 0;
+
+    bool visible_ = true;
+    bool appForeground_ = true;
+    int frameRate_ = 0;
+
     std::shared_ptr<WPEViewOHOSRenderer> wpeViewRenderer_ = nullptr;
 
     std::vector<gulong> signalHandlers_;
@@ -1,4 +1,85 @@
+// Options for the first init() call; later calls keep the runtime as started.
+export interface WebKitRuntimeOptions {
+  // 'main' (default): WebKit runs on the ArkTS thread, driven by its event
+  // loop. 'dedicated': WebKit runs on a thread of its own.
+  threadMode?: 'main' | 'dedicated';
+  // 'main' thread mode only: how GLib's fds are watched, the time budget
+  // (microseconds) for GLib work per loop iteration, after which posted
+  // calls wait for the next iteration (0 = one GLib iteration), and
+  // the granularity (microseconds) GLib timers are rounded up to so that
+  // nearby ones share a wakeup (0 = exact; once a view presents, the frame
+  // interval, aligned to the display's vsync).
+  pollMode?: 'perFd' | 'epoll';
+  dispatchBudgetUs?: number;
+  timerSlackUs?: number;
+  // 'main' thread mode only: report WebKit dispatches that block the ArkTS
+  // thread for at least this many milliseconds (0 = off). Reports are kept
+  // for getStallReports() and written to the app's files/faultlog directory.
+  stallThresholdMs?: number;
+  // Start WebKit's processes as soon as the runtime is up rather than on the
+  // first load: 'processes' launches the web and network processes,
+  // 'blankPage' also loads about:blank in a web view the first view adopts.
+  prewarm?: 'none' | 'processes' | 'blankPage';
+  // Number of constructed web views kept ready for new views to adopt,
+  // refilled when WebKit is idle (0 = off).
+  webViewPoolSize?: number;
+  // Hand WebKit's buffers to the window without a copy when they fit the
+  // surface (default false; experimental, not yet validated on a device).
+  directPresent?: boolean;
+  // Memory pressure monitor (replaces WebKit's, which is off on OHOS): poll
+  // interval (default 0 = off; 2000 is a reasonable value) and the used
+  // memory percentages at which WebKit's caches are shed (default 90) and
+  // idle views released too (default 95).
+  memoryPressureIntervalMs?: number;
+  memoryPressureNonCriticalPct?: number;
+  memoryPressureCriticalPct?: number;
+}
+
+export type WebKitLoadEvent = 'started' | 'redirected' | 'committed' | 'finished';
+
 export default interface WebKitInterface {
-  init(): void;
+  init(options?: WebKitRuntimeOptions): void;
   loadURL(url: string): void;
+  // Tears the view down: its web view, renderer and listener are released and
+  // WebKit ends the web process once no other view uses it. Call from the
+  // XComponent's onDestroy; a re-created XComponent gets a new view on init().
+  destroy(): void;
+  // A hidden view presents no frames and WebKit throttles its page's rAF,
+  // timers and media. setVisible() follows this view's XComponent;
+  // setAppForeground() follows the ability and applies to every view.
+  setVisible(visible: boolean): void;
+  setAppForeground(foreground: boolean): void;
+  // Presents at most fps frames per second (e.g. 30, 60 or 120), on every
+  // Nth vsync so frames stay evenly paced; 0, the default, follows the display.
+  setFrameRate(fps: number): void;
+  // Called on the ArkTS thread; pass undefined to remove.
+  setLoadChangedListener(listener: ((event: WebKitLoadEvent, url: string) => void) | undefined): void;
+  // MessagePump instrumentation; getPumpStats() returns a JSON snapshot
+  // (durations in ns; wakeups count loop iterations ended by a GLib fd or
+  // timeout) or "null" while disabled (always in 'dedicated' mode).
+  setPumpStatsEnabled(enabled: boolean): void;
+  getPumpStats(): string;
+  // Stall watchdog reports as JSON (source, duration, backtrace), or "null"
+  // while it is off.
+  getStallReports(): string;
+  // Cold start phase times (ms since the first init()) and prewarm state as
+  // JSON; unreached phases are null.
+  getPrewarmStats(): string;
+  // Builds with WEBKITVIEW_STARTUP_TRACE only: writes the cold start trace
+  // (Chrome trace JSON) to the app's cache directory and returns its path;
+  // "" otherwise.
+  writeStartupTrace(): string;
+  // Web view pool state and init()-to-first-frame times (ms) of pooled and
+  // unpooled views, as JSON.
+  getWebViewPoolStats(): string;
+  // Memory pressure level, last meminfo/cgroup/PSI reading and event counts
+  // as JSON.
+  getMemoryPressureStats(): string;
+  // Surface-created-to-first-frame times (ms) when the EGL context was kept
+  // from the previous surface and when it had to be created, and surface size
+  // changes against the WebKit relayouts they caused, the renderer's CPU
+  // time per frame (ms), the interval between an animation's frames (ms),
+  // texture cache hits/misses, pixels drawn per frame and zero-copy presents,
+  // as JSON.
+  getSurfaceStats(): string;
 }
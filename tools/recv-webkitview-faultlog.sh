@@ -14,4 +14,24 @@ need hdc
 HDC_CMD=(hdc)
 if [[ -n "${HDC_TARGET:-}" ]]; then HDC_CMD+=( -t "$HDC_TARGET" ); fi
 
-hdc shell 'ls -t /data/log/faultlog/faultlogger/cppcrash-com.kodegood.webkitview-* | head -n 1' | xargs -I{} hdc file recv {} .
+# KIND=cppcrash (default): the newest native crash log from faultlogger.
+# KIND=stall: every stall watchdog dump the app wrote to its files/faultlog
+# directory (init({ stallThresholdMs })). Both symbolize with
+# tools/symbolize-faultlog.sh.
+KIND="${KIND:-cppcrash}"
+
+case "$KIND" in
+  cppcrash)
+    hdc shell 'ls -t /data/log/faultlog/faultlogger/cppcrash-com.kodegood.webkitview-* | head -n 1' | xargs -I{} hdc file recv {} .
+    ;;
+  stall)
+    STALL_DIR="/data/app/el2/100/base/${BUNDLE_NAME}/haps/entry/files/faultlog"
+    say "Fetching stall dumps from $STALL_DIR"
+    "${HDC_CMD[@]}" shell "ls $STALL_DIR/webkitview-stall-*.log 2>/dev/null" | tr -d '\r' | while read -r f; do
+      [[ -n "$f" ]] && "${HDC_CMD[@]}" file recv "$f" .
+    done
+    ;;
+  *)
+    die "Unknown KIND '$KIND' (expected cppcrash or stall)"
+    ;;
+esac
@@ -0,0 +1,50 @@
+#!/bin/bash
+
+# Prints the CPU time the app and its WebKit child processes use over
+# DURATION seconds. Run it with the app in the foreground and again with it
+# in the background to see what hidden-view throttling saves.
+#
+#   DURATION=30 tools/webkitview-cpu-time.sh
+
+set -Eeuo pipefail
+
+die(){ echo "ERROR: $*" >&2; exit 2; }
+say(){ printf "\n==> %s\n" "$*"; }
+need(){ command -v "$1" >/dev/null 2>&1 || die "Missing '$1' in PATH"; }
+
+# ---------- Defaults ----------
+BUNDLE_NAME="${BUNDLE_NAME:-com.kodegood.webkitview}"
+DURATION="${DURATION:-30}"
+
+need hdc
+HDC_CMD=(hdc)
+if [[ -n "${HDC_TARGET:-}" ]]; then HDC_CMD+=( -t "$HDC_TARGET" ); fi
+
+# utime + stime, in clock ticks, of the app process and its direct children.
+cpu_ticks() {
+  "${HDC_CMD[@]}" shell "
+    app=\$(pidof $BUNDLE_NAME | cut -d' ' -f1)
+    [ -n \"\$app\" ] || { echo -1; exit; }
+    total=0
+    for d in /proc/[0-9]*; do
+      stat=\$(cat \$d/stat 2>/dev/null) || continue
+      set -- \${stat#*) }
+      # After the command: state ppid ... utime (12th) stime (13th).
+      if [ \"\${d#/proc/}\" = \"\$app\" ] || [ \"\$2\" = \"\$app\" ]; then
+        total=\$((total + \${12} + \${13}))
+      fi
+    done
+    echo \$total" | tr -d '\r'
+}
+
+HZ=$("${HDC_CMD[@]}" shell "getconf CLK_TCK 2>/dev/null || echo 100" | tr -d '\r')
+
+START=$(cpu_ticks)
+(( START >= 0 )) || die "$BUNDLE_NAME is not running"
+say "Sampling $BUNDLE_NAME for ${DURATION} s"
+sleep "$DURATION"
+END=$(cpu_ticks)
+(( END >= 0 )) || die "$BUNDLE_NAME exited while sampling"
+
+CPU_MS=$(( (END - START) * 1000 / HZ ))
+echo "CPU time: ${CPU_MS} ms over ${DURATION} s ($(( CPU_MS / (DURATION * 10) ))% of one core)"
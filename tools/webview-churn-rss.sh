@@ -0,0 +1,88 @@
+#!/bin/bash
+
+# Checks that destroying a web view gives its memory back. Launches the app so
+# that it removes and re-creates its XComponent N times (churnCycles), each
+# time under a new XComponent id, then compares the RSS of the app and its
+# WebKit child processes after the first cycle (baseline) with the RSS after
+# the last one.
+#
+#   CYCLES=40 TOLERANCE_PCT=10 tools/webview-churn-rss.sh
+#
+# Exits 1 when the final RSS exceeds the baseline by more than TOLERANCE_PCT,
+# or when a re-created view could not be registered (the default CYCLES is
+# above the runtime's 32 live views, so destroyed views must free theirs).
+
+set -Eeuo pipefail
+
+die(){ echo "ERROR: $*" >&2; exit 2; }
+say(){ printf "\n==> %s\n" "$*"; }
+need(){ command -v "$1" >/dev/null 2>&1 || die "Missing '$1' in PATH"; }
+
+# ---------- Defaults ----------
+BUNDLE_NAME="${BUNDLE_NAME:-com.kodegood.webkitview}"
+ABILITY_NAME="${ABILITY_NAME:-EntryAbility}"
+CYCLES="${CYCLES:-40}"
+INTERVAL_MS="${INTERVAL_MS:-3000}"
+TOLERANCE_PCT="${TOLERANCE_PCT:-10}"
+
+need hdc
+HDC_CMD=(hdc)
+if [[ -n "${HDC_TARGET:-}" ]]; then HDC_CMD+=( -t "$HDC_TARGET" ); fi
+
+(( CYCLES >= 2 )) || die "CYCLES must be at least 2"
+
+# Sum of VmRSS (kB) of the app process and its direct children (the WebKit
+# web and network processes).
+rss_kb() {
+  "${HDC_CMD[@]}" shell "
+    app=\$(pidof $BUNDLE_NAME | cut -d' ' -f1)
+    [ -n \"\$app\" ] || { echo 0; exit; }
+    total=0
+    for d in /proc/[0-9]*; do
+      p=\${d#/proc/}
+      ppid=\$(cut -d' ' -f4 \$d/stat 2>/dev/null) || continue
+      if [ \"\$p\" = \"\$app\" ] || [ \"\$ppid\" = \"\$app\" ]; then
+        kb=\$(grep VmRSS \$d/status 2>/dev/null | tr -s ' ' | cut -d' ' -f2)
+        total=\$((total + \${kb:-0}))
+      fi
+    done
+    echo \$total" | tr -d '\r'
+}
+
+# Blocks until the app has logged the end of churn cycle $1.
+wait_cycle() {
+  local deadline=$(( SECONDS + (INTERVAL_MS * 2 / 1000) + 30 ))
+  until "${HDC_CMD[@]}" shell "hilog -x | grep -q 'churn cycle $1 done'" ; do
+    (( SECONDS < deadline )) || die "Timed out waiting for churn cycle $1"
+    sleep 1
+  done
+}
+
+say "Restarting $BUNDLE_NAME with $CYCLES churn cycles every $((INTERVAL_MS * 2)) ms"
+"${HDC_CMD[@]}" shell "aa force-stop $BUNDLE_NAME" >/dev/null
+"${HDC_CMD[@]}" shell "hilog -r" >/dev/null
+"${HDC_CMD[@]}" shell "aa start -b $BUNDLE_NAME -a $ABILITY_NAME --pi churnCycles $CYCLES --pi churnIntervalMs $INTERVAL_MS"
+
+wait_cycle 1
+# Let the re-created view load its page before sampling.
+sleep $(( INTERVAL_MS / 1000 ))
+BASELINE=$(rss_kb)
+say "Baseline RSS after cycle 1: ${BASELINE} kB"
+
+wait_cycle "$CYCLES"
+sleep $(( INTERVAL_MS / 1000 ))
+FINAL=$(rss_kb)
+say "RSS after cycle $CYCLES: ${FINAL} kB"
+
+(( BASELINE > 0 )) || die "Could not read the app's RSS"
+if "${HDC_CMD[@]}" shell "hilog -x | grep -q 'live views; ignoring'"; then
+  echo "FAIL: a re-created view was not registered"
+  exit 1
+fi
+GROWTH_PCT=$(( (FINAL - BASELINE) * 100 / BASELINE ))
+echo "Growth: ${GROWTH_PCT}% (tolerance ${TOLERANCE_PCT}%)"
+if (( GROWTH_PCT > TOLERANCE_PCT )); then
+  echo "FAIL: RSS did not return to baseline"
+  exit 1
+fi
+echo "PASS"